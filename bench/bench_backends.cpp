@@ -0,0 +1,49 @@
+// benchmark: one full process table refresh with each collector backend
+// run as root to include taskstats, it falls back to procfs otherwise
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../include/reader.hpp"
+
+// refreshing the table the given number of rounds, returns microseconds per refresh
+static double timeRefresh(ProcTable &table, int rounds){
+    table.refresh(0, 0); // warming up, every pid is new on the first pass
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r){
+        table.refresh(0, 0);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::micro>(elapsed).count() / rounds;
+}
+
+int main(int argc, char **argv){
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 50;
+    int workers = argc > 2 ? std::atoi(argv[2]) : 1;
+    if (rounds < 1){
+        rounds = 1;
+    }
+    if (workers < 1){
+        workers = 1;
+    }
+
+    ProcTable procfs(workers, ProcBackend::Procfs);
+    ProcTable taskstats(workers, ProcBackend::Taskstats);
+
+    double procfs_us = timeRefresh(procfs, rounds);
+    std::printf("pids: %zu, rounds: %d, workers: %d\n", procfs.size(), rounds, workers);
+    std::printf("%-10s %10.1f us/refresh %8.0f ns/pid\n", "procfs", procfs_us, procfs_us * 1000.0 / procfs.size());
+
+    if (taskstats.backend() != ProcBackend::Taskstats){
+        std::printf("%-10s unavailable (needs CAP_NET_ADMIN and CONFIG_TASKSTATS)\n", "taskstats");
+        return 0;
+    }
+
+    double taskstats_us = timeRefresh(taskstats, rounds);
+    std::printf("%-10s %10.1f us/refresh %8.0f ns/pid\n", "taskstats", taskstats_us, taskstats_us * 1000.0 / taskstats.size());
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+// micro-benchmark: per-pid cost of parsing /proc/<pid>/stat
+// compares the original ifstream/istringstream parser with readProcStat()
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "../include/reader.hpp"
+
+// the parser readProcStat() replaced, kept here as the baseline
+static bool legacyReadProcStat(const std::string &pid, ProcStat& ps){
+    std::string path = "/proc/" + pid + "/stat";
+    std::ifstream file(path);
+
+    if (!file){
+        return false;
+    }
+
+    std::string line;
+    std::getline(file, line);
+
+    size_t open = line.find('(');
+    size_t close = line.rfind(')');
+
+    if (open == std::string::npos || close == std::string::npos){
+        return false;
+    }
+
+    ps.pid = std::stoi(line.substr(0, open));
+    ps.process_name = line.substr(open+1, close-open-1);
+
+    std::istringstream iss(line.substr(close + 2));
+
+    char state;
+    iss >> state;
+    iss >> ps.ppid;
+
+    unsigned long long skip;
+    iss >> skip >> skip >> skip >> skip >> skip >> skip >> skip >> skip >> skip;
+    iss >> ps.utime >> ps.stime;
+    iss >> skip >> skip >> skip >> skip;
+    iss >> ps.threads;
+    iss >> skip >> ps.starttime;
+    iss >> ps.vsize >> ps.rss;
+
+    long page_size_kb = sysconf(_SC_PAGE_SIZE)/1024;
+    ps.memb_kb = ps.rss * page_size_kb;
+
+    return true;
+}
+
+static std::vector<std::string> listPids(){
+    std::vector<std::string> pids;
+
+    DIR *dir = opendir("/proc");
+    if (!dir){
+        return pids;
+    }
+
+    while (dirent *entry = readdir(dir)){
+        if (entry->d_name[0] >= '1' && entry->d_name[0] <= '9'){
+            pids.emplace_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+
+    return pids;
+}
+
+// running fn over every pid for the given number of rounds, returns ns per pid
+template <typename Fn>
+static double timePerPid(const std::vector<std::string> &pids, int rounds, Fn fn){
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r){
+        for (const std::string &pid : pids){
+            fn(pid);
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    return ns / (static_cast<double>(pids.size()) * rounds);
+}
+
+int main(int argc, char **argv){
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 200;
+    if (rounds < 1){
+        rounds = 1;
+    }
+
+    std::vector<std::string> pids = listPids();
+    if (pids.empty()){
+        std::fprintf(stderr, "no pids found in /proc\n");
+        return 1;
+    }
+
+    ProcStat ps{};
+    unsigned long checksum = 0; // keeping the compiler from dropping the parse
+
+    double legacy_ns = timePerPid(pids, rounds, [&](const std::string &pid){
+        if (legacyReadProcStat(pid, ps)){
+            checksum += ps.utime;
+        }
+    });
+
+    double current_ns = timePerPid(pids, rounds, [&](const std::string &pid){
+        if (readProcStat(liveSource(), pid.c_str(), ps)){
+            checksum += ps.utime;
+        }
+    });
+
+    std::printf("pids: %zu, rounds: %d\n", pids.size(), rounds);
+    std::printf("%-28s %10.0f ns/pid\n", "ifstream + istringstream", legacy_ns);
+    std::printf("%-28s %10.0f ns/pid\n", "openat + from_chars", current_ns);
+    std::printf("speedup: %.2fx (checksum %lu)\n", legacy_ns / current_ns, checksum);
+
+    return 0;
+}
@@ -0,0 +1,644 @@
+// benchmark suite: every reader and panel draw run against generated /proc trees
+// usage: bench_suite [pid counts] [cpu counts], e.g. bench_suite 1000,10000,100000 8,64,512
+// the trees are written to $TMPDIR (or /tmp) and removed afterwards
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ftw.h>
+#include <iterator>
+#include <memory>
+#include <ncurses.h>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#include "../include/cgroup.hpp"
+#include "../include/history.hpp"
+#include "../include/net.hpp"
+#include "../include/panels.hpp"
+#include "../include/reader.hpp"
+#include "../include/search.hpp"
+#include "harness.hpp"
+
+// the proc panel's size while drawing, a typical full screen terminal
+static const int PROC_PANEL_HEIGHT = 50;
+static const int PANEL_WIDTH = 200;
+
+// services the fixture's processes are spread over, each its own cgroup
+static const size_t FIXTURE_CGROUPS = 40;
+
+// interfaces in the fixture's /proc/net/dev, a container host's veths and bridges
+static const size_t FIXTURE_INTERFACES = 400;
+
+// the trends kept while drawing, vtop's defaults
+static const size_t HISTORY_SAMPLES = 120;
+static const size_t HISTORY_TOP_PROCS = 16;
+
+// ─────────────────────────────────────────────
+// Fixtures
+// ─────────────────────────────────────────────
+
+// a process name and command line for every kind of process a real system has plenty of
+struct FixtureProcess{
+    const char *name;
+    const char *cmdline; // arguments separated by '|', empty for kernel threads
+};
+
+// names as the kernel keeps them, at most 15 characters (TASK_COMM_LEN - 1)
+static const FixtureProcess FIXTURE_PROCESSES[] = {
+    {"kworker/3:1", ""},
+    {"bash", "-bash"},
+    {"python3", "/usr/bin/python3|-u|/srv/app/worker.py|--queue=default"},
+    {"postgres", "postgres: checkpointer"},
+    {"nginx", "nginx: worker process"},
+    {"java", "/usr/lib/jvm/java-17/bin/java|-Xmx2g|-XX:+UseG1GC|-jar|/opt/service/service.jar|--spring.profiles.active=prod"},
+    {"sshd", "sshd: user@pts/0"},
+    {"chrome", "/opt/google/chrome/chrome|--type=renderer|--lang=en-US|--enable-crash-reporter|--renderer-client-id=42"},
+};
+
+static bool writeFile(const std::string &path, const std::string &contents){
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (!file){
+        return false;
+    }
+    bool ok = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+static std::string fixtureStat(size_t cpus){
+    std::string out;
+    char line[256];
+
+    for (size_t i = 0; i <= cpus; ++i){
+        unsigned long long scale = i == 0 ? cpus : 1;
+        unsigned long long seed = i * 7919;
+        char name[32] = "cpu ";
+        if (i > 0){
+            std::snprintf(name, sizeof(name), "cpu%zu", i - 1);
+        }
+        std::snprintf(line, sizeof(line), "%s %llu %llu %llu %llu %llu %llu %llu %llu 0 0\n", name,
+            scale * (182734 + seed % 9000), scale * (312 + seed % 50), scale * (64021 + seed % 3000), scale * (9812736 + seed % 70000),
+            scale * (4211 + seed % 400), scale * 0, scale * (1203 + seed % 100), scale * 0);
+        out += line;
+    }
+
+    out += "intr 182736412 0 9 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n";
+    out += "ctxt 391827364\nbtime 1760000000\nprocesses 918273\nprocs_running 2\nprocs_blocked 0\n";
+    out += "softirq 51827364 0 9182736 2 1827364 0 0 283746 18273645 0 2837465\n";
+    return out;
+}
+
+static std::string fixtureMeminfo(){
+    static const char *const lines[] = {
+        "MemTotal:       65843512 kB", "MemFree:        21837264 kB", "MemAvailable:   48273645 kB",
+        "Buffers:          812736 kB", "Cached:         23827364 kB", "SwapCached:            0 kB",
+        "Active:         18273645 kB", "Inactive:       19283746 kB", "Active(anon):    9182736 kB",
+        "Inactive(anon):   182736 kB", "Active(file):    9090909 kB", "Inactive(file): 19101010 kB",
+        "Unevictable:       32768 kB", "Mlocked:           32768 kB", "SwapTotal:       8388604 kB",
+        "SwapFree:        8388604 kB", "Zswap:                 0 kB", "Zswapped:              0 kB",
+        "Dirty:               812 kB", "Writeback:             0 kB", "AnonPages:       9283746 kB",
+        "Mapped:          1827364 kB", "Shmem:            918273 kB", "KReclaimable:    1283746 kB",
+        "Slab:            2183746 kB", "SReclaimable:    1283746 kB", "SUnreclaim:       900000 kB",
+        "KernelStack:       28736 kB", "PageTables:       91827 kB", "SecPageTables:         0 kB",
+        "NFS_Unstable:          0 kB", "Bounce:                0 kB", "WritebackTmp:          0 kB",
+        "CommitLimit:    41310360 kB", "Committed_AS:   21837465 kB", "VmallocTotal:   34359738367 kB",
+        "VmallocUsed:      182736 kB", "VmallocChunk:          0 kB", "Percpu:            28672 kB",
+        "HardwareCorrupted:     0 kB", "AnonHugePages:   2097152 kB", "ShmemHugePages:        0 kB",
+        "ShmemPmdMapped:        0 kB", "FileHugePages:         0 kB", "FilePmdMapped:         0 kB",
+        "HugePages_Total:       0", "HugePages_Free:        0", "HugePages_Rsvd:        0",
+        "HugePages_Surp:        0", "Hugepagesize:       2048 kB", "Hugetlb:               0 kB",
+        "DirectMap4k:      812736 kB", "DirectMap2M:    18273645 kB", "DirectMap1G:    49283746 kB",
+    };
+
+    std::string out;
+    for (const char *line : lines){
+        out += line;
+        out += '\n';
+    }
+    return out;
+}
+
+// the cgroup2 look-alike next to the /proc one, holding the fixture's processes
+static std::string fixtureCgroupRoot(const std::string &root){
+    return root + "/fs-cgroup";
+}
+
+// a cgroup2 hierarchy with FIXTURE_CGROUPS services under root
+static bool makeCgroupFixture(const std::string &root){
+    if (mkdir(root.c_str(), 0755) != 0 || mkdir((root + "/system.slice").c_str(), 0755) != 0){
+        return false;
+    }
+    if (!writeFile(root + "/cgroup.controllers", "cpuset cpu io memory pids\n")){
+        return false;
+    }
+
+    char contents[512];
+    for (size_t group = 0; group < FIXTURE_CGROUPS; ++group){
+        std::string dir = root + "/system.slice/service-" + std::to_string(group) + ".service";
+        if (mkdir(dir.c_str(), 0755) != 0){
+            return false;
+        }
+
+        std::snprintf(contents, sizeof(contents), "usage_usec %zu\nuser_usec %zu\nsystem_usec %zu\nnr_periods 0\nnr_throttled 0\nthrottled_usec 0\n",
+                      group * 7919000, group * 5000000, group * 2919000);
+        if (!writeFile(dir + "/cpu.stat", contents)){
+            return false;
+        }
+        std::snprintf(contents, sizeof(contents), "%zu\n", (group + 1) * 52428800);
+        if (!writeFile(dir + "/memory.current", contents)){
+            return false;
+        }
+        std::snprintf(contents, sizeof(contents),
+            "anon %zu\nfile %zu\nkernel %zu\nkernel_stack 65536\npagetables 409600\nsec_pagetables 0\npercpu 2048\n"
+            "sock 0\nvmalloc 0\nshmem 0\nfile_mapped 1048576\nfile_dirty 0\nfile_writeback 0\nswapcached 0\n",
+            (group + 1) * 31457280, (group + 1) * 20971520, (group + 1) * 1048576);
+        if (!writeFile(dir + "/memory.stat", contents)){
+            return false;
+        }
+    }
+    return true;
+}
+
+// /proc/net/dev with loopback, one uplink, a bridge and veths for the rest
+static std::string fixtureNetDev(){
+    std::string out =
+        "Inter-|   Receive                                                |  Transmit\n"
+        " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n";
+
+    char name[32];
+    char line[256];
+    for (size_t i = 0; i < FIXTURE_INTERFACES; ++i){
+        if (i == 0){
+            std::snprintf(name, sizeof(name), "lo");
+        } else if (i == 1){
+            std::snprintf(name, sizeof(name), "eth0");
+        } else if (i == 2){
+            std::snprintf(name, sizeof(name), "docker0");
+        } else {
+            std::snprintf(name, sizeof(name), "veth%06zx", i * 2654435761u % 0xffffff);
+        }
+        unsigned long long bytes = (i + 1) * 987654321ull;
+        std::snprintf(line, sizeof(line), "%6s: %llu %llu %zu %zu 0 0 0 %zu %llu %llu 0 %zu 0 0 0 0\n",
+                      name, bytes, bytes / 900, i % 3, i % 7, i % 5, bytes / 3, bytes / 2700, i % 11);
+        out += line;
+    }
+    return out;
+}
+
+// writing a /proc look-alike with pids 1..pids and cpus cores under root
+static bool makeFixture(const std::string &root, size_t pids, size_t cpus){
+    if (mkdir(root.c_str(), 0755) != 0){
+        return false;
+    }
+    if (!writeFile(root + "/stat", fixtureStat(cpus)) || !writeFile(root + "/meminfo", fixtureMeminfo())){
+        return false;
+    }
+    if (!makeCgroupFixture(fixtureCgroupRoot(root))){
+        return false;
+    }
+
+    if (mkdir((root + "/net").c_str(), 0755) != 0 || !writeFile(root + "/net/dev", fixtureNetDev())){
+        return false;
+    }
+
+    // a busy machine's stalls, every resource with a "full" line as on 5.13 and later
+    if (mkdir((root + "/pressure").c_str(), 0755) != 0){
+        return false;
+    }
+    const char *const pressure[] = {"cpu", "memory", "io"};
+    for (size_t i = 0; i < std::size(pressure); ++i){
+        char contents[256];
+        std::snprintf(contents, sizeof(contents),
+            "some avg10=%zu.53 avg60=%zu.11 avg300=3.11 total=%zu\nfull avg10=0.%zu0 avg60=0.00 avg300=0.00 total=%zu\n",
+            i * 12, i * 5, 128933278 * (i + 1), i, 9933278 * i);
+        if (!writeFile(root + "/pressure/" + pressure[i], contents)){
+            return false;
+        }
+    }
+
+    std::string dir, contents;
+    char line[1024];
+    const size_t kinds = sizeof(FIXTURE_PROCESSES) / sizeof(FIXTURE_PROCESSES[0]);
+
+    for (size_t pid = 1; pid <= pids; ++pid){
+        const FixtureProcess &proc = FIXTURE_PROCESSES[pid % kinds];
+        bool kernel = proc.cmdline[0] == '\0';
+
+        dir = root + "/" + std::to_string(pid);
+        if (mkdir(dir.c_str(), 0755) != 0){
+            return false;
+        }
+
+        unsigned long rss = kernel ? 0 : 1000 + (pid * 2654435761u) % 500000;
+        std::snprintf(line, sizeof(line),
+            "%zu (%s) S %zu %zu %zu 0 -1 4194560 %zu 0 0 0 %zu %zu 0 0 20 0 %zu 0 %zu %lu %lu "
+            "18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 %zu 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+            pid, proc.name, static_cast<size_t>(kernel ? 2 : 1), pid, pid, pid * 31 % 100000, pid * 13 % 50000, pid * 7 % 20000,
+            kernel ? 1 : 1 + pid % 32, 1000 + pid, kernel ? 0 : rss * 4096 * 3, rss, pid % cpus);
+        if (!writeFile(dir + "/stat", line)){
+            return false;
+        }
+
+        contents.assign(proc.cmdline);
+        for (char &c : contents){
+            if (c == '|'){
+                c = '\0';
+            }
+        }
+        if (!kernel){
+            contents.push_back('\0');
+        }
+        if (!writeFile(dir + "/cmdline", contents)){
+            return false;
+        }
+
+        std::snprintf(line, sizeof(line),
+            "rchar: %zu\nwchar: %zu\nsyscr: %zu\nsyscw: %zu\nread_bytes: %zu\nwrite_bytes: %zu\ncancelled_write_bytes: 0\n",
+            pid * 40961, pid * 12289, pid * 17, pid * 5, pid * 4096 % 1000000, pid * 8192 % 3000000);
+        if (!writeFile(dir + "/io", line)){
+            return false;
+        }
+
+        // kernel threads map nothing, their rollup is empty
+        contents.clear();
+        if (!kernel){
+            unsigned long rss_kb = rss * 4;
+            std::snprintf(line, sizeof(line),
+                "55d0c0a00000-7ffd1e5f7000 ---p 00000000 00:00 0                          [rollup]\n"
+                "Rss:            %8lu kB\nPss:            %8lu kB\nPss_Dirty:      %8lu kB\nPss_Anon:       %8lu kB\n"
+                "Pss_File:       %8lu kB\nPss_Shmem:             0 kB\nShared_Clean:   %8lu kB\nShared_Dirty:          0 kB\n"
+                "Private_Clean:  %8lu kB\nPrivate_Dirty:  %8lu kB\nReferenced:     %8lu kB\nAnonymous:      %8lu kB\n"
+                "LazyFree:              0 kB\nAnonHugePages:         0 kB\nShmemPmdMapped:        0 kB\nFilePmdMapped:         0 kB\n"
+                "Shared_Hugetlb:        0 kB\nPrivate_Hugetlb:       0 kB\nSwap:                  0 kB\nSwapPss:               0 kB\n"
+                "Locked:                0 kB\n",
+                rss_kb, rss_kb * 3 / 4, rss_kb / 2, rss_kb / 2, rss_kb / 4, rss_kb / 2, rss_kb / 8, rss_kb * 3 / 8, rss_kb, rss_kb / 2);
+            contents.assign(line);
+        }
+        if (!writeFile(dir + "/smaps_rollup", contents)){
+            return false;
+        }
+
+        // kernel threads stay in the root cgroup, the rest belong to a service
+        contents.assign("0::/");
+        if (!kernel){
+            contents += "system.slice/service-" + std::to_string(pid % FIXTURE_CGROUPS) + ".service";
+        }
+        contents.push_back('\n');
+        if (!writeFile(dir + "/cgroup", contents)){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int removeEntry(const char *path, const struct stat *, int, struct FTW *){
+    return remove(path);
+}
+
+static void removeFixture(const std::string &root){
+    nftw(root.c_str(), removeEntry, 64, FTW_DEPTH | FTW_PHYS);
+}
+
+// "1000,10000" into {1000, 10000}
+static std::vector<size_t> parseSizes(const char *text){
+    std::vector<size_t> sizes;
+    while (*text){
+        char *end;
+        unsigned long long value = std::strtoull(text, &end, 10);
+        if (end == text){
+            break;
+        }
+        if (value > 0){
+            sizes.push_back(value);
+        }
+        text = *end == ',' ? end + 1 : end;
+    }
+    return sizes;
+}
+
+// ─────────────────────────────────────────────
+// Panels
+// ─────────────────────────────────────────────
+
+// an ncurses screen writing to /dev/null, sized to the panel being drawn
+// (doupdate() cost grows with the screen, so it is never bigger than a real one would be)
+struct NullScreen{
+    FILE *out = nullptr;
+    FILE *in = nullptr;
+    SCREEN *screen = nullptr;
+
+    bool open(){
+        out = std::fopen("/dev/null", "w");
+        in = std::fopen("/dev/null", "r");
+        const char *term = std::getenv("TERM");
+        screen = out && in ? newterm(term && *term ? term : "xterm", out, in) : nullptr;
+        if (!screen){
+            return false;
+        }
+        set_term(screen);
+        typeahead(-1); // nothing to read, doupdate() would poll the input for every line otherwise
+        if (has_colors()){
+            start_color();
+            for (short pair = 1; pair <= 8; ++pair){
+                init_pair(pair, pair % 8, COLOR_BLACK);
+            }
+        }
+        return true;
+    }
+
+    ~NullScreen(){
+        if (screen){
+            endwin();
+            delscreen(screen);
+        }
+        if (out) std::fclose(out);
+        if (in) std::fclose(in);
+    }
+};
+
+// two snapshots differing in every number a panel shows, drawn in turn so every row changes
+static void makeAlternate(const SystemSnapshot &snapshot, SystemSnapshot &other){
+    other = snapshot;
+    for (float &busy : other.cpu.busy){
+        busy = 100.0f - busy;
+    }
+    for (ProcStat &p : other.procs){
+        p.cpu_percent += 1.0;
+        p.memb_kb += 4;
+    }
+    other.mem.used_kb += 4096;
+    other.generation += 1;
+    other.sample += 1;
+}
+
+// filling every ring so the sparklines are drawn at full width
+static void fillHistory(History &history, const SystemSnapshot &snapshot, const SystemSnapshot &other){
+    for (size_t i = 0; i < history.capacity(); ++i){
+        history.push(i % 2 ? other : snapshot);
+    }
+}
+
+// ─────────────────────────────────────────────
+// Benchmarks
+// ─────────────────────────────────────────────
+
+static unsigned long g_checksum = 0; // keeping the compiler from dropping results
+
+static void benchSystem(const std::string &root, size_t cpus, bool panels){
+    ProcfsSource source(root.c_str());
+
+    char fixture[64];
+    std::snprintf(fixture, sizeof(fixture), "%zu cpus", cpus);
+
+    CpuCounters prev, curr;
+    printBench("readCpuCounters", fixture, runBench(1, [&]{
+        readCpuCounters(source, curr);
+        g_checksum += curr.rows();
+    }));
+
+    // the fixture does not tick, so the deltas are all zero, which costs the same
+    readCpuCounters(source, prev);
+    CpuUsage usage;
+    printBench("computeCpuUsage", fixture, runBench(1, [&]{
+        computeCpuUsage(prev, curr, usage);
+        g_checksum += usage.rows();
+    }));
+
+    printBench("getMemInfo", fixture, runBench(1, [&]{
+        g_checksum += getMemInfo(source).total_kb;
+    }));
+
+    // the fixture does not move, so every interface gets a rate of zero, which costs the same
+    NetTable net;
+    std::vector<NetStat> interfaces;
+    uint64_t net_ns = 0;
+    printBench("NetTable::sample (400 ifaces)", fixture, runBench(1, [&]{
+        net_ns += 1000000000;
+        net.sample(source, net_ns, interfaces);
+        g_checksum += interfaces.size();
+    }));
+
+    PressureStat pressure;
+    printBench("readPressure (3 files)", fixture, runBench(1, [&]{
+        for (size_t i = 0; i < PRESSURE_RESOURCES; ++i){
+            readPressure(source, static_cast<PressureResource>(i), pressure);
+            g_checksum += pressure.some.total_us;
+        }
+    }));
+
+    if (!panels){
+        return;
+    }
+
+    SystemReader reader(1, ProcBackend::Procfs, source);
+    auto snapshot = std::make_shared<SystemSnapshot>();
+    reader.sample(*snapshot, {}, {});
+    auto other = std::make_shared<SystemSnapshot>();
+    makeAlternate(*snapshot, *other);
+    History history(HISTORY_SAMPLES, cpus, HISTORY_TOP_PROCS);
+    fillHistory(history, *snapshot, *other);
+
+    // half of a full screen terminal, as vtop gives it: bars, then columns, then a heatmap as cores grow
+    // (the cores split over two sockets, so the heatmap has a group for each)
+    CpuTopology topology;
+    for (size_t cpu = 0; cpu < cpus; ++cpu){
+        topology.socket.push_back(cpu < cpus / 2 ? 0 : 1);
+        topology.node.push_back(-1);
+    }
+    CPUPanel cpuPanel(1, PANEL_WIDTH / 2, 0, 0);
+    cpuPanel.setTopology(topology, CpuGrouping::Auto);
+    int height = cpuPanel.fitHeight(*snapshot, PANEL_WIDTH / 2, PROC_PANEL_HEIGHT / 2);
+    resizeterm(height, PANEL_WIDTH);
+    cpuPanel.rebuild(height, PANEL_WIDTH / 2, 0, 0);
+
+    // first frame or resize: a new window and the whole terminal repainted
+    printBench("CPUPanel full draw", fixture, runBench(1, [&]{
+        cpuPanel.rebuild(height, PANEL_WIDTH / 2, 0, 0);
+        cpuPanel.drawCPUStats(*snapshot, history);
+        clearok(curscr, TRUE);
+        doupdate();
+    }));
+
+    bool flip = false;
+    printBench("CPUPanel update", fixture, runBench(1, [&]{
+        flip = !flip;
+        cpuPanel.drawCPUStats(flip ? *other : *snapshot, history);
+        doupdate();
+    }));
+}
+
+static void benchProcesses(const std::string &root, size_t pids, bool panels){
+    ProcfsSource source(root.c_str());
+
+    char fixture[64];
+    std::snprintf(fixture, sizeof(fixture), "%zu pids", pids);
+
+    std::vector<std::string> names;
+    for (size_t pid = 1; pid <= pids; ++pid){
+        names.push_back(std::to_string(pid));
+    }
+
+    ProcStat ps{};
+    printBench("readProcStat (per pid)", fixture, runBench(pids, [&]{
+        for (const std::string &pid : names){
+            if (readProcStat(source, pid.c_str(), ps)){
+                g_checksum += ps.utime;
+            }
+        }
+    }));
+
+    printBench("readProcIo (per pid)", fixture, runBench(pids, [&]{
+        for (const std::string &pid : names){
+            if (readProcIo(source, pid.c_str(), ps)){
+                g_checksum += ps.read_bytes;
+            }
+        }
+    }));
+
+    printBench("readSmapsRollup (per pid)", fixture, runBench(pids, [&]{
+        for (const std::string &pid : names){
+            if (readSmapsRollup(source, pid.c_str(), ps)){
+                g_checksum += ps.pss_kb;
+            }
+        }
+    }));
+
+    std::string cmdline;
+    printBench("readCmdLine (per pid)", fixture, runBench(pids, [&]{
+        for (const std::string &pid : names){
+            if (readCmdLine(source, pid.c_str(), cmdline)){
+                g_checksum += cmdline.size();
+            }
+        }
+    }));
+
+    ProcTable table(1, ProcBackend::Procfs, source);
+    printBench("ProcTable::refresh", fixture, runBench(1, [&]{
+        table.refresh(0, 0);
+        g_checksum += table.size();
+    }));
+
+    // the sampler's whole job: what getProcStats() did, plus cpu and memory, one visible page of command lines and i/o
+    SystemReader reader(1, ProcBackend::Procfs, source);
+    std::vector<int> visible;
+    for (int pid = 1; pid <= PROC_PANEL_HEIGHT && pid <= static_cast<int>(pids); ++pid){
+        visible.push_back(pid);
+    }
+    auto snapshot = std::make_shared<SystemSnapshot>();
+    printBench("SystemReader::sample", fixture, runBench(1, [&]{
+        reader.sample(*snapshot, visible, visible);
+        g_checksum += snapshot->num_procs;
+    }));
+
+    // grouping by cgroup: looking every pid up once, after that a sample only sums the processes
+    // and reads the files of each cgroup
+    CgroupTable cgroups(fixtureCgroupRoot(root).c_str());
+    std::vector<ProcStat> grouped = snapshot->procs;
+    printBench("readPidCgroup (per pid)", fixture, runBench(pids, [&]{
+        char name[16];
+        for (ProcStat &p : grouped){
+            std::snprintf(name, sizeof(name), "%d", p.pid);
+            p.cgroup = readPidCgroup(source, name, cgroups);
+            g_checksum += p.cgroup;
+        }
+    }));
+
+    std::vector<CgroupStat> cgroup_stats;
+    uint64_t cgroup_ns = 0;
+    printBench("CgroupTable::aggregate", fixture, runBench(1, [&]{
+        cgroup_ns += 1000000000;
+        cgroups.aggregate(grouped, cgroup_ns, cgroup_stats);
+        g_checksum += cgroup_stats.size();
+    }));
+
+    // one keystroke of the search prompt
+    ProcSearchIndex index;
+    index.update(snapshot->procs);
+    ProcFilter filter;
+    std::string error;
+    parseProcFilter("pyth", filter, error);
+    std::vector<int> matches;
+    printBench("ProcSearchIndex::match", fixture, runBench(1, [&]{
+        index.match(snapshot->procs, filter, matches);
+        g_checksum += matches.size();
+    }));
+
+    // what every new sample costs the trends: ranking the processes and one value per series
+    auto other = std::make_shared<SystemSnapshot>();
+    makeAlternate(*snapshot, *other);
+    History history(HISTORY_SAMPLES, snapshot->num_cpus, HISTORY_TOP_PROCS);
+    size_t pushes = 0;
+    printBench("History::push", fixture, runBench(1, [&]{
+        history.push(++pushes % 2 ? *other : *snapshot);
+        g_checksum += history.size();
+    }));
+
+    if (!panels){
+        return;
+    }
+
+    fillHistory(history, *snapshot, *other);
+    std::shared_ptr<const SystemSnapshot> shown[] = {snapshot, other};
+
+    resizeterm(PROC_PANEL_HEIGHT, PANEL_WIDTH);
+    ProcPanel procPanel(PROC_PANEL_HEIGHT, PANEL_WIDTH, 0, 0);
+
+    printBench("ProcPanel full draw", fixture, runBench(1, [&]{
+        procPanel.rebuild(PROC_PANEL_HEIGHT, PANEL_WIDTH, 0, 0);
+        procPanel.drawProcStats(shown[0], history);
+        clearok(curscr, TRUE);
+        doupdate();
+    }));
+
+    // a new snapshot every time: re-indexing, re-ordering the page and redrawing every row
+    size_t flip = 0;
+    printBench("ProcPanel new snapshot", fixture, runBench(1, [&]{
+        flip ^= 1;
+        procPanel.drawProcStats(shown[flip], history);
+        doupdate();
+    }));
+}
+
+int main(int argc, char **argv){
+    std::vector<size_t> pid_counts = parseSizes(argc > 1 ? argv[1] : "1000,10000,100000");
+    std::vector<size_t> cpu_counts = parseSizes(argc > 2 ? argv[2] : "8,64,512");
+
+    const char *tmp = std::getenv("TMPDIR");
+    std::string base = std::string(tmp && *tmp ? tmp : "/tmp") + "/vtop-bench-" + std::to_string(getpid());
+
+    NullScreen screen;
+    bool panels = screen.open();
+
+    printBenchHeader();
+
+    for (size_t cpus : cpu_counts){
+        std::string root = base + "-cpus-" + std::to_string(cpus);
+        if (!makeFixture(root, 0, cpus)){
+            std::fprintf(stderr, "could not write fixture %s\n", root.c_str());
+            removeFixture(root);
+            return 1;
+        }
+        benchSystem(root, cpus, panels);
+        removeFixture(root);
+    }
+
+    for (size_t pids : pid_counts){
+        std::string root = base + "-pids-" + std::to_string(pids);
+        if (!makeFixture(root, pids, 8)){
+            std::fprintf(stderr, "could not write fixture %s\n", root.c_str());
+            removeFixture(root);
+            return 1;
+        }
+        benchProcesses(root, pids, panels);
+        removeFixture(root);
+    }
+
+    if (!panels){
+        std::printf("panel draws skipped, no terminfo entry for $TERM\n");
+    }
+    std::printf("(checksum %lu)\n", g_checksum);
+    return 0;
+}
@@ -0,0 +1,160 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+// shared harness for the benchmarks: a timing loop plus allocation and syscall counters
+// include it from exactly one translation unit, it replaces global operator new and
+// interposes the libc wrappers the readers and ncurses call (open, openat, read, pread,
+// write, close, dup); syscalls libc makes internally, like readdir()'s getdents64, are not seen
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <new>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static std::atomic<unsigned long> g_bench_allocs{0};
+static std::atomic<unsigned long> g_bench_syscalls{0};
+
+// ─────────────────────────────────────────────
+// counting allocations
+// ─────────────────────────────────────────────
+
+void *operator new(size_t size){
+    g_bench_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)){
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size){
+    return operator new(size);
+}
+
+// kept out of line, gcc otherwise sees free() of what it takes for an operator new pointer
+__attribute__((noinline)) void operator delete(void *p) noexcept{
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void *p) noexcept{
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept{
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void *p, size_t) noexcept{
+    std::free(p);
+}
+
+// ─────────────────────────────────────────────
+// counting syscalls, the wrappers go straight to the kernel
+// ─────────────────────────────────────────────
+
+static void countSyscall(){
+    g_bench_syscalls.fetch_add(1, std::memory_order_relaxed);
+}
+
+extern "C" {
+
+int open(const char *path, int flags, ...){
+    mode_t mode = 0;
+    if (flags & (O_CREAT | O_TMPFILE)){
+        va_list args;
+        va_start(args, flags);
+        mode = va_arg(args, mode_t);
+        va_end(args);
+    }
+    countSyscall();
+    return static_cast<int>(syscall(SYS_openat, AT_FDCWD, path, flags, mode));
+}
+
+int openat(int dir_fd, const char *path, int flags, ...){
+    mode_t mode = 0;
+    if (flags & (O_CREAT | O_TMPFILE)){
+        va_list args;
+        va_start(args, flags);
+        mode = va_arg(args, mode_t);
+        va_end(args);
+    }
+    countSyscall();
+    return static_cast<int>(syscall(SYS_openat, dir_fd, path, flags, mode));
+}
+
+ssize_t read(int fd, void *buf, size_t size){
+    countSyscall();
+    return syscall(SYS_read, fd, buf, size);
+}
+
+ssize_t pread(int fd, void *buf, size_t size, off_t offset){
+    countSyscall();
+    return syscall(SYS_pread64, fd, buf, size, offset);
+}
+
+ssize_t write(int fd, const void *buf, size_t size){
+    countSyscall();
+    return syscall(SYS_write, fd, buf, size);
+}
+
+int close(int fd){
+    countSyscall();
+    return static_cast<int>(syscall(SYS_close, fd));
+}
+
+int dup(int fd){
+    countSyscall();
+    return static_cast<int>(syscall(SYS_dup, fd));
+}
+
+}
+
+// ─────────────────────────────────────────────
+// timing loop
+// ─────────────────────────────────────────────
+
+struct BenchResult{
+    double ns; // per op
+    double allocs; // per op
+    double syscalls; // per op
+};
+
+// calling fn (which performs ops operations) once to warm up, then until at least min_time has passed
+template <typename Fn>
+static BenchResult runBench(size_t ops, Fn fn, std::chrono::milliseconds min_time = std::chrono::milliseconds(200)){
+    fn();
+
+    unsigned long allocs = g_bench_allocs.load();
+    unsigned long syscalls = g_bench_syscalls.load();
+    size_t calls = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = start - start;
+    do {
+        fn();
+        ++calls;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed < min_time);
+
+    double total_ops = static_cast<double>(ops) * calls;
+    BenchResult result;
+    result.ns = std::chrono::duration<double, std::nano>(elapsed).count() / total_ops;
+    result.allocs = (g_bench_allocs.load() - allocs) / total_ops;
+    result.syscalls = (g_bench_syscalls.load() - syscalls) / total_ops;
+    return result;
+}
+
+static void printBenchHeader(){
+    std::printf("%-30s %-22s %14s %12s %14s\n", "benchmark", "fixture", "ns/op", "allocs/op", "syscalls/op");
+}
+
+static void printBench(const char *name, const char *fixture, const BenchResult &result){
+    std::printf("%-30s %-22s %14.0f %12.2f %14.2f\n", name, fixture, result.ns, result.allocs, result.syscalls);
+    std::fflush(stdout);
+}
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef CGROUP_H
+#define CGROUP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "reader.hpp"
+#include "source.hpp"
+
+// ─────────────────────────────────────────────
+// CgroupTable — cgroup v2 paths the processes belong to, and each one's own accounting
+// a path is interned once, processes only carry its id (ProcStat::cgroup)
+// ─────────────────────────────────────────────
+class CgroupTable{
+public:
+    // root is where the cgroup2 hierarchy is mounted (or its "unified" directory on hybrid systems),
+    // benchmarks point it at a fixture tree
+    explicit CgroupTable(const char *root = "/sys/fs/cgroup");
+    ~CgroupTable();
+
+    // to prevent accidental copying
+    CgroupTable(const CgroupTable&) = delete;
+    CgroupTable& operator=(const CgroupTable&) = delete;
+
+    // id of path ("/system.slice/cron.service"), adding it if it is new
+    int intern(const char *path, size_t len);
+
+    // summing procs into the cgroups they belong to and reading the accounting of every cgroup
+    // that has at least one, at now_ns (the source's clock); cgroups left empty are forgotten
+    void aggregate(const std::vector<ProcStat> &procs, uint64_t now_ns, std::vector<CgroupStat> &out);
+
+private:
+    struct Entry{
+        std::string path; // empty for a free id
+        long row = -1; // its row in the current aggregate() output, -1 if no process is in it
+        unsigned long long prev_usage_usec = 0; // cpu.stat usage_usec of the previous aggregate()
+        uint64_t prev_ns = 0; // when it was read, 0 if never
+    };
+
+    // reading the cgroup's own files into stat
+    void readAccounting(Entry &entry, uint64_t now_ns, CgroupStat &stat);
+    // reading file of the cgroup at path into buf, returns the number of bytes read or -1
+    ssize_t readFile(const std::string &path, const char *file, char *buf, size_t size);
+
+    int m_root_fd; // the cgroup2 mount
+    std::vector<Entry> m_entries; // indexed by id
+    std::vector<int> m_free; // ids of forgotten cgroups, reused first
+    std::unordered_map<std::string, int> m_ids; // path -> id
+    std::string m_path; // scratch, path of the file being read
+};
+
+// the cgroup v2 path in the contents of /proc/<pid>/cgroup (its "0::" line), false if there is none
+bool parsePidCgroup(const char *buf, size_t len, const char *&path, size_t &path_len);
+
+// id of the cgroup pid belongs to, interned into cgroups, -1 if it could not be read
+int readPidCgroup(ProcSource &source, const char *pid, CgroupTable &cgroups);
+
+#endif
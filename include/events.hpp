@@ -0,0 +1,91 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <poll.h>
+
+// kernel objects the ui and sampler threads sleep on, each a file descriptor poll() can wait for
+
+// ─────────────────────────────────────────────
+// IntervalTimer — timerfd ticking every interval on CLOCK_MONOTONIC
+// the kernel keeps the cadence, however long the work between two ticks takes
+// ─────────────────────────────────────────────
+class IntervalTimer{
+public:
+    IntervalTimer();
+    ~IntervalTimer();
+
+    // to prevent accidental copying
+    IntervalTimer(const IntervalTimer&) = delete;
+    IntervalTimer& operator=(const IntervalTimer&) = delete;
+
+    // ticking every interval from one interval from now, false if the timer could not be set
+    bool start(std::chrono::nanoseconds interval);
+
+    int fd() const { return m_fd; }
+
+    // ticks since the last call, 0 if there were none (never blocks)
+    uint64_t consume();
+
+private:
+    int m_fd;
+};
+
+// ─────────────────────────────────────────────
+// Waker — eventfd one thread notifies to wake another out of poll()
+// notifications coalesce: however many there were, one drain() clears them
+// ─────────────────────────────────────────────
+class Waker{
+public:
+    Waker();
+    ~Waker();
+
+    // to prevent accidental copying
+    Waker(const Waker&) = delete;
+    Waker& operator=(const Waker&) = delete;
+
+    void notify();
+    void drain();
+
+    int fd() const { return m_fd; }
+
+private:
+    int m_fd;
+};
+
+// ─────────────────────────────────────────────
+// SignalWatch — signalfd receiving signals as readable events instead of through a handler
+// the signals are blocked in the constructing thread, so it has to run before any other thread starts
+// (threads inherit the mask, and a signal left unblocked in one of them would be delivered there)
+// ─────────────────────────────────────────────
+class SignalWatch{
+public:
+    explicit SignalWatch(std::initializer_list<int> signals);
+    ~SignalWatch();
+
+    // to prevent accidental copying
+    SignalWatch(const SignalWatch&) = delete;
+    SignalWatch& operator=(const SignalWatch&) = delete;
+
+    int fd() const { return m_fd; }
+
+    // next pending signal, 0 once there are none left (never blocks)
+    int next();
+
+private:
+    int m_fd;
+};
+
+// poll() retried on EINTR: waiting until one of fds is ready or timeout_ms passes (-1 waits for ever)
+// returns the number of ready fds, 0 on timeout and -1 on any other error (with errno set),
+// which has to end the caller's loop: waiting again would fail again at once, without ever blocking
+int waitForEvents(pollfd *fds, size_t count, int timeout_ms);
+
+// sleeping until the next tick of timer, for loops with nothing else to wait for
+// returns 1 on a tick, 0 once one of the watched signals arrived and -1 if poll() failed (errno set)
+int waitForTick(IntervalTimer &timer, SignalWatch &signals);
+
+#endif
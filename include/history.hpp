@@ -0,0 +1,74 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "reader.hpp"
+
+// memory series kept by History, % of total memory
+enum class MemSeries{
+    Used,
+    Buffers,
+    Cached,
+    Free,
+    Count
+};
+
+// ─────────────────────────────────────────────
+// History — the last capacity samples of every series, one fixed ring per series,
+// rings of the same kind back to back in one array (core c's ring starts at c * capacity)
+// everything is allocated up front, so pushing a sample never allocates
+// (apart from the process ranking scratch growing to a new record process count)
+// ─────────────────────────────────────────────
+class History{
+public:
+    // cpus is the number of cores to keep (the aggregate row is kept on top of them),
+    // top_procs the number of processes tracked by cpu and again by memory
+    History(size_t capacity, size_t cpus, size_t top_procs);
+
+    // appending one sample, the oldest one is dropped once the rings are full
+    void push(const SystemSnapshot &snapshot);
+
+    size_t capacity() const { return m_capacity; }
+    size_t size() const { return m_count; }
+
+    // copying the latest values of a series, oldest first, into out (at most n)
+    // returns how many were copied, values a process was not around for are NaN
+    size_t coreUsage(size_t core, float *out, size_t n) const; // core 0 is the aggregate "cpu" row, in %
+    size_t mem(MemSeries series, float *out, size_t n) const;
+    size_t procCpu(const ProcStat &p, float *out, size_t n) const; // 0 if p is not tracked (a new process on a tracked pid is not)
+    size_t procRssKB(const ProcStat &p, float *out, size_t n) const;
+
+private:
+    // a process slot: its rings follow the same layout as the cores'
+    struct ProcSlot{
+        int pid = 0; // 0 while free
+        unsigned long long starttime = 0;
+        unsigned long ranked = 0; // push number the process was last among the top ones
+    };
+
+    size_t copyOut(const std::vector<float> &rings, size_t ring, float *out, size_t n) const;
+    int findSlot(int pid) const;
+    int findSlot(const ProcStat &p) const; // the slot of this very process, pid and start time
+    void rank(const SystemSnapshot &snapshot);
+    void track(const ProcStat &p);
+
+    size_t m_capacity;
+    size_t m_cores; // rings in m_core_usage, aggregate included
+    size_t m_top;
+    size_t m_next = 0; // index samples are written at
+    size_t m_count = 0;
+    unsigned long m_pushes = 0;
+
+    std::vector<float> m_core_usage;
+    std::vector<float> m_mem; // MemSeries::Count rings
+    std::vector<ProcSlot> m_slots; // 2 * top_procs
+    std::vector<float> m_proc_cpu; // one ring per slot
+    std::vector<float> m_proc_rss_kb;
+    std::vector<int> m_order; // process ranking scratch, indices into snapshot.procs
+    std::vector<std::pair<int, int>> m_tracked; // (pid, slot) of tracked processes, sorted by pid
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef NET_H
+#define NET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "reader.hpp"
+#include "source.hpp"
+
+// ─────────────────────────────────────────────
+// NetTable — counters of every interface in /proc/net/dev, kept between samples for their rates
+// an interface keeps its slot for as long as it exists, so hosts with hundreds of
+// veths and bridges cost no allocation per sample once their names have been seen
+// ─────────────────────────────────────────────
+class NetTable{
+public:
+    NetTable() = default;
+
+    // to prevent accidental copying
+    NetTable(const NetTable&) = delete;
+    NetTable& operator=(const NetTable&) = delete;
+
+    // reading /proc/net/dev at now_ns (the source's clock) into out, one row per interface in the kernel's order,
+    // false if it could not be read (out is then empty); interfaces that went away are forgotten
+    bool sample(ProcSource &source, uint64_t now_ns, std::vector<NetStat> &out);
+
+private:
+    struct Slot{
+        std::string name; // empty for a free slot
+        NetCounters counters; // as of the sample it was last seen in
+        unsigned long tick = 0; // that sample
+    };
+
+    // slot of the interface name, adding it if it is new; row is where it is in this sample,
+    // interfaces rarely move so the slot the same row had last time is tried before the map
+    size_t slotOf(const char *name, size_t len, size_t row);
+
+    std::vector<Slot> m_slots;
+    std::vector<size_t> m_free; // slots of interfaces that went away, reused first
+    std::unordered_map<std::string, size_t> m_ids; // name -> slot
+    std::vector<size_t> m_rows; // slot of every row of the previous sample
+    std::string m_contents; // the file, keeps the size of the largest read
+    std::string m_name; // scratch, name being looked up
+    unsigned long m_tick = 0; // samples so far
+    uint64_t m_prev_ns = 0; // now_ns of the previous sample
+};
+
+// the name and counters in one interface line of /proc/net/dev ("  eth0: 1234 56 0 0 0 0 0 0 789 12 0 0 0 0 0 0"),
+// false for the two header lines or anything else that is not one
+bool parseNetDevLine(const char *p, const char *end, const char *&name, size_t &name_len, NetCounters &counters);
+
+#endif
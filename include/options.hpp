@@ -0,0 +1,25 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "reader.hpp"
+#include "topology.hpp"
+
+// command line options
+struct Options{
+    std::chrono::milliseconds sample_interval{1000}; // time between two samples
+    size_t history_samples = 120; // samples kept for the sparklines
+    size_t scan_workers = 0; // threads scanning /proc, 0 picks online cores / 4
+    ProcBackend proc_backend = ProcBackend::Procfs; // where per-process counters come from
+    CpuGrouping cpu_grouping = CpuGrouping::Auto; // what the cpu heatmap groups cores by
+    bool pss = false; // reading smaps_rollup of the rows on screen for their PSS and USS
+    std::string record_path; // headless mode: recording to this file instead of drawing
+    std::string dump_path; // printing this recording instead of drawing
+    std::string capture_path; // headless mode: capturing raw /proc contents to this file
+    std::string replay_path; // drawing this capture instead of the running system
+};
+
+#endif
@@ -0,0 +1,508 @@
+#ifndef PANELS_H
+#define PANELS_H
+
+#include <cstddef>
+#include <memory>
+#include <ncurses.h>
+#include <string>
+#include <vector>
+
+#include "history.hpp"
+#include "profile.hpp"
+#include "reader.hpp"
+#include "search.hpp"
+#include "topology.hpp"
+
+// the panels the ui is made of, kept apart from the main loop so benchmarks can draw them too
+
+// ─────────────────────────────────────────────
+// Panel — base class for all panels
+// ─────────────────────────────────────────────
+class Panel{
+protected:
+    WINDOW *win; // window
+    std::string m_title; // title
+    int m_title_color_pair; // color pair
+    int m_height, m_width; // height and width of the window
+    int m_pos_y, m_pos_x; // position of the window
+
+    // retained frame: border and title are drawn once per layout, and every row
+    // remembers what it showed so unchanged rows are never touched again
+    bool m_chrome_drawn = false;
+    std::vector<std::string> m_rows;
+
+    // remembering that row y now shows content, returns false if it already did (nothing to draw)
+    bool rowChanged(int y, const char *content, size_t len);
+
+    // printing text at (y, x) if the row changed, clearing the rest of the row inside the border
+    void drawTextRow(int y, int x, const char *text, size_t len);
+
+    // redrawing the bottom border under a footer that changed, so a shorter one leaves nothing behind
+    void clearBottomBorder();
+
+public:
+    // constructor
+    Panel
+    (
+        const std::string& title,
+        int title_color_pair,
+        int height,
+        int width,
+        int pos_y,
+        int pos_x
+    );
+
+    // destructor
+    virtual ~Panel();
+
+    // to prevent accidental copying
+    Panel(const Panel&) = delete;
+    Panel& operator=(const Panel&) = delete;
+
+    // drawing the border and title, once per layout
+    void drawPanel();
+
+    // marking every line for copying on the next wnoutrefresh, after an overlay covering it went away
+    void touch();
+
+    // resizing the panel
+    void rebuild(int height, int width, int pos_y, int pos_x);
+};
+
+// ─────────────────────────────────────────────
+// System Info Panel — displays system info
+// extends Panel class
+// ─────────────────────────────────────────────
+class SystemInfoPanel : public Panel {
+private:
+    void drawVisuals(const SystemSnapshot &snapshot);
+
+public:
+    SystemInfoPanel(
+        int height, // height of the panel
+        int width, // width of the panel
+        int y, // y coordinate of the panel
+        int x // x coordinate of the panel
+    );
+
+    // function to draw system info
+    void drawSysInfo(const SystemSnapshot &snapshot);
+};
+
+// ─────────────────────────────────────────────
+// Procs Panel — displays processes
+// extends Panel class
+// ─────────────────────────────────────────────
+enum class ProcSortKey{
+    Pid, // ascending
+    Name, // ascending
+    Threads, // descending from here on
+    Memory,
+    Vsize,
+    Cpu,
+    ReadRate, // rows without i/o rates last
+    WriteRate,
+    Syscalls
+};
+
+class ProcPanel : public Panel {
+private:
+    std::shared_ptr<const SystemSnapshot> m_snapshot; // snapshot currently on screen
+    std::vector<int> m_order; // indices into the snapshot's procs, in display order within [m_sorted_begin, m_sorted_end)
+    int m_sorted_begin = 0, m_sorted_end = 0; // rows of m_order that are in their final place
+    ProcSortKey m_sort_key = ProcSortKey::Memory;
+    int m_page = 0;
+    bool m_pss = false; // PSS and USS columns next to resident memory
+
+    const History *m_history = nullptr; // trends of the top processes
+    std::vector<float> m_trend; // scratch, one series at a time
+
+    // search: the index follows every snapshot so a keystroke only costs one pass over it
+    ProcSearchIndex m_index;
+    ProcFilter m_filter; // parsed from m_filter_text
+    std::string m_filter_text; // as typed after '/'
+    std::string m_filter_error; // first term that did not parse
+    std::string m_filter_before; // m_filter_text when the prompt was opened, restored by esc
+    bool m_editing = false; // prompt open, keys go to the filter
+
+    // rows worth ordering: the current page plus the command line prefetch pages around it
+    void orderWindow(int &begin, int &end) const;
+
+    // placing the rows [begin, end) of the index array: nth_element partitions everything
+    // ranking above begin and below end out of the way, only the window itself is sorted,
+    // so a page costs O(n + rows log rows) instead of sorting every process
+    template <typename Less>
+    void orderRange(int begin, int end, Less less);
+
+    // an i/o rate to sort by, below any real one for rows whose i/o was not read
+    static double ioRate(const ProcStat &p, double rate);
+
+    // making sure the rows about to be shown are ordered, the index array moves but ProcStats never do
+    void orderProcs();
+
+    // a new snapshot, sort key or filter, nothing is in place any more
+    void resetOrder();
+
+    // re-parsing the filter after the text changed, back to the first page of matches
+    void applyFilter();
+
+    // footer text: the prompt while typing, otherwise page, filter and sort
+    int footer(char *line, size_t size, int total_pages) const;
+
+    void drawVisuals();
+
+public:
+    ProcPanel(
+        int height, // height of the panel
+        int width, // width of the panel
+        int y, // y coordinate of the panel
+        int x // x coordinate of the panel
+    );
+
+    // function to draw proc stats
+    void drawProcStats(std::shared_ptr<const SystemSnapshot> snapshot, const History &history);
+
+    // showing PSS and USS next to resident memory, for samplers reading smaps_rollup
+    void setPss(bool pss);
+
+    ProcSortKey sortKey() const { return m_sort_key; }
+
+    void setSortKey(ProcSortKey key);
+
+    bool editingFilter() const { return m_editing; }
+
+    // opening the search prompt on the current filter
+    void startFilter();
+
+    // a key typed into the search prompt, the list narrows with every keystroke
+    void editFilter(int ch);
+
+    // pids of the rows on the current page plus the pages on either side,
+    // the only ones whose command lines are worth reading
+    // (while a command filter needs every command line to match against, all of those not read yet,
+    // so the request only changes when new processes show up)
+    void cmdlineWindow(std::vector<int> &pids) const;
+
+    // pids of the rows on the current page, the only ones whose disk i/o and PSS are worth reading
+    void shownWindow(std::vector<int> &pids) const;
+
+    void changePage(int direction);
+};
+
+// ─────────────────────────────────────────────
+// CgroupPanel — processes grouped by cgroup, shown in place of the proc panel
+// extends Panel class
+// ─────────────────────────────────────────────
+class CgroupPanel : public Panel {
+private:
+    std::shared_ptr<const SystemSnapshot> m_snapshot; // snapshot currently on screen
+    std::vector<int> m_order; // indices into the snapshot's cgroups, in display order
+    ProcSortKey m_sort_key = ProcSortKey::Cpu; // follows the proc panel's
+    int m_page = 0;
+
+    // the cgroup's own numbers where it has them, its processes' sums otherwise
+    static double cpuOf(const CgroupStat &c);
+    static unsigned long long memoryOf(const CgroupStat &c);
+
+    // there are a handful of cgroups next to thousands of processes, so every row is simply sorted
+    void orderCgroups();
+
+    void drawVisuals();
+
+public:
+    CgroupPanel(
+        int height, // height of the panel
+        int width, // width of the panel
+        int y, // y coordinate of the panel
+        int x // x coordinate of the panel
+    );
+
+    // function to draw the cgroups, ordered by the proc panel's sort key
+    void drawCgroups(std::shared_ptr<const SystemSnapshot> snapshot, ProcSortKey sort_key);
+
+    void changePage(int direction);
+};
+
+// what the net panel orders interfaces by
+enum class NetSortKey{
+    Throughput, // received and sent bytes together
+    Rx,
+    Tx,
+    Name
+};
+
+// ─────────────────────────────────────────────
+// NetPanel — network interfaces by throughput, shown in place of the proc panel
+// a host with hundreds of veths and bridges is narrowed with a name filter and idle
+// interfaces can be hidden, only the rows up to the current page are ever ordered
+// extends Panel class
+// ─────────────────────────────────────────────
+class NetPanel : public Panel {
+private:
+    std::shared_ptr<const SystemSnapshot> m_snapshot; // snapshot currently on screen
+    std::vector<int> m_order; // indices into the snapshot's interfaces that pass the filter, ordered up to m_ordered
+    size_t m_ordered = 0; // how many of m_order are in display order, the rest are in no particular order
+    int m_page = 0;
+    NetSortKey m_sort_key = NetSortKey::Throughput;
+    bool m_hide_idle = false; // leaving out interfaces that moved nothing in the last interval
+    std::string m_filter_text; // substring of the names shown, "!" in front to leave them out instead
+    std::string m_filter_before; // filter when the prompt was opened, restored on esc
+    bool m_editing = false; // prompt open, keys go to the filter
+
+    static double throughput(const NetStat &n);
+
+    static bool idle(const NetStat &n);
+
+    int maxRows() const;
+
+    bool passesFilter(const NetStat &n) const;
+
+    // the interfaces that pass the filter, then only as many ordered as the pages up to the current one show
+    // (the busiest first, or by name, ties in the kernel's order so rows do not swap places between refreshes)
+    void orderInterfaces();
+
+    // footer text: the prompt while typing, otherwise page, filter and the view's keys
+    int footer(char *line, size_t size, int total_pages) const;
+
+    void drawVisuals();
+
+public:
+    NetPanel(
+        int height, // height of the panel
+        int width, // width of the panel
+        int y, // y coordinate of the panel
+        int x // x coordinate of the panel
+    );
+
+    // function to draw the interfaces, the busiest first
+    void drawNet(std::shared_ptr<const SystemSnapshot> snapshot);
+
+    void changePage(int direction);
+
+    void setSortKey(NetSortKey key);
+
+    // showing or leaving out interfaces that moved nothing in the last interval
+    void toggleIdle();
+
+    bool editingFilter() const { return m_editing; }
+
+    // opening the filter prompt on the current filter
+    void startFilter();
+
+    // a key typed into the filter prompt, the list narrows with every keystroke
+    void editFilter(int ch);
+};
+
+// ─────────────────────────────────────────────
+// MemPanel — displays memory utilisation
+// extends Panel class
+// ─────────────────────────────────────────────
+class MemPanel : public Panel{
+private:
+    MemStat m_mem_info;
+    unsigned long long m_active_memory; // truly used memory (green)
+    unsigned long long m_buffer; // buffers (blue)
+    unsigned long long m_cached; // cache (yellow)
+    unsigned long long m_free; // free (space)
+    unsigned long long m_total; // total space
+    std::vector<float> m_trend; // scratch for the used memory sparkline
+    std::string m_spark;
+
+    // function to get memory stats
+    void getMemStats(const MemStat &mem);
+
+    // function to calculate number of bars
+    std::vector<int> calculateBars(int container_width, const unsigned long long& total_memory, const unsigned long long& active_memory, const unsigned long long& buffer, const unsigned long long& cached);
+
+    // one labelled amount, redrawn only when it changed
+    void drawAmount(int row, int color, const char *label, unsigned long long kb);
+
+    void drawVisuals(const MemStat &mem, const History &history);
+
+public:
+    MemPanel(
+        int height, // height of the panel
+        int width, // width of the panel
+        int y, // y coordinate of the panel
+        int x // x coordinate of the panel
+    );
+
+    // function to draw memory stats
+    void drawMemStats(const SystemSnapshot &snapshot, const History &history);
+};
+
+// rows of the pressure panel: border, header, one per resource, border
+static const int PRESSURE_PANEL_HEIGHT = 3 + static_cast<int>(PRESSURE_RESOURCES);
+
+// ─────────────────────────────────────────────
+// PressurePanel — pressure stall information: how much of the time tasks waited
+// for cpu, memory or io, which utilisation alone does not show
+// extends Panel class
+// ─────────────────────────────────────────────
+class PressurePanel : public Panel{
+private:
+    // one value on a row, with the colour its level gets
+    struct Cell{
+        char text[16];
+        int color;
+    };
+
+    // green while stalls are rare, yellow once they are noticeable, red when work is held up
+    static int levelColor(float percent);
+
+    // avg10, avg60, the share of the last interval and the stall time in it, "-" where the kernel has none
+    static void lineCells(const PressureLine &line, bool present, bool has_delta, Cell *cells);
+
+    // widest cell that still fits eight of them next to the labels
+    int cellWidth() const;
+
+    void drawHeader(int cell_width);
+
+    void drawResource(int row, PressureResource resource, const PressureStat &stat, int cell_width);
+
+public:
+    PressurePanel(
+        int height, // height of the panel
+        int width, // width of the panel
+        int y, // y coordinate of the panel
+        int x // x coordinate of the panel
+    );
+
+    // whether the snapshot has pressure for any resource, the panel is left out otherwise
+    static bool available(const SystemSnapshot &snapshot);
+
+    // function to draw pressure stats
+    void drawPressure(const SystemSnapshot &snapshot);
+};
+
+// rows of the cpu panel that are not cores: border, time breakdown, aggregate bar, divider, border
+static const int CPU_PANEL_CHROME = 5;
+
+// how the cpu panel lays out its cores, picked from the core count and the room it has
+enum class CpuLayoutMode{
+    Bars, // one full width bar per row
+    Columns, // short bars, several per row
+    Heatmap // one character per core (or per few cores), grouped by numa node or socket
+};
+
+struct CpuLayout{
+    CpuLayoutMode mode;
+    int rows; // rows the cores take
+    int cells_per_row; // Columns: bars per row, Heatmap: characters per row
+    int cell_width; // Columns: width of one bar with its label and percentage
+    size_t cores_per_cell; // Heatmap: cores averaged into one character
+};
+
+// ─────────────────────────────────────────────
+// CPUPanel — displays per-core CPU utilisation
+// extends Panel class
+// ─────────────────────────────────────────────
+class CPUPanel : public Panel{
+private:
+    // cores sharing a numa node or socket, as rows of SystemSnapshot::cpu
+    struct CoreGroup{
+        std::string label;
+        std::vector<size_t> cores;
+    };
+
+    // function to generate bars
+    std::string generateBars(int container_width, double utilization_percent);
+
+    // function to get color
+    int getColor(double utilization);
+
+    // containing utilization to [0, 100] just in case
+    static double clampUsage(double utilization);
+
+    // "cpu" for the aggregate row, "cpuN" for core N
+    static int cpuName(int id, char *out, size_t size);
+
+    // where the aggregate's time went, on the line above its bar
+    // (as many fields as fit, iowait and steal ahead of the rarely busy ones)
+    void drawBreakdown(const CpuUsage &cpu);
+
+    // function to draw visuals on the terminal
+    void drawVisual(const CpuUsage &cpu, size_t core, int row, const History &history);
+
+    // one row of the column grid, cores running down each column before the next one starts
+    void drawColumnsRow(const CpuUsage &cpu, const CpuLayout &layout, int r, int row);
+
+    // one row of the heatmap: cells [first_cell, first_cell + cells) of group
+    void drawHeatmapRow(const CpuUsage &cpu, const CpuLayout &layout, const CoreGroup &group, size_t first_cell, size_t cells, int row);
+
+    // regrouping the cores whenever /proc/stat lists a different number of them
+    void updateGroups(const CpuUsage &cpu);
+
+    // heatmap rows needed with per_cell cores to a character and chars characters to a row
+    size_t heatmapRows(size_t per_cell, size_t chars) const;
+
+    // the roomiest layout that shows cores in at most body_rows rows of a panel width wide
+    CpuLayout layoutFor(size_t cores, int width, int body_rows) const;
+
+    CpuTopology m_topology;
+    CpuGrouping m_grouping = CpuGrouping::None; // resolved, never Auto
+    size_t m_grouped_cpus = 0; // rows of SystemSnapshot::cpu m_groups was made for
+    std::vector<CoreGroup> m_groups;
+    int m_name_width = 5; // longest core name
+
+    std::vector<float> m_trend; // scratch for one core's sparkline
+    std::string m_spark;
+    std::string m_key;
+    std::string m_heat; // scratch for one heatmap row
+
+public:
+    CPUPanel(
+        int height, // height of the panel
+        int width, // width of the panel
+        int y, // y coordinate of the panel
+        int x // x coordinate of the panel
+    );
+
+    // setting what the heatmap groups cores by
+    void setTopology(const CpuTopology &topology, CpuGrouping grouping);
+
+    // the height the panel needs for the cores of snapshot at width, given at most max_height rows
+    int fitHeight(const SystemSnapshot &snapshot, int width, int max_height);
+
+    // function to draw CPU stats
+    void drawCPUStats(const SystemSnapshot &snapshot, const History &history);
+};
+
+// ─────────────────────────────────────────────
+// ProfilePanel — overlay with vtop's own cost: cpu and memory from /proc/self,
+// and the latest durations of every stage of sampling and drawing
+// ─────────────────────────────────────────────
+class ProfilePanel : public Panel{
+private:
+    // "950ns", "12.3us", "4.56ms", "1.20s", at most 7 characters
+    static void formatDuration(char *buf, size_t size, uint64_t ns);
+
+    // one character per log2 bucket, darker for fuller buckets
+    static void formatHistogram(char *buf, const Profiler::Summary &summary);
+
+public:
+    // borders, the self usage row, the column header and one row per stage
+    static int height();
+
+    static int width();
+
+    ProfilePanel(int y, int x);
+
+    void drawProfile(const SelfUsage &self, unsigned long long frame_bytes);
+};
+
+// ─────────────────────────────────────────────
+// MainPanel — the frame around every other panel,
+// with status text on the left and key help on the right of its bottom border
+// ─────────────────────────────────────────────
+class MainPanel : public Panel{
+public:
+    MainPanel(int height, int width);
+
+    void drawMain(const std::string &status, const std::string &help);
+
+private:
+    std::string m_footer; // scratch, keeps its capacity
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ─────────────────────────────────────────────
+// WorkerPool — small fixed pool of threads that run indexed tasks
+// the calling thread takes part, so a pool of size 1 runs everything inline
+// ─────────────────────────────────────────────
+class WorkerPool{
+public:
+    explicit WorkerPool(size_t threads); // total threads, caller included
+    ~WorkerPool();
+
+    // to prevent accidental copying
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t size() const { return m_threads.size() + 1; }
+
+    // calling task(0) .. task(tasks - 1) across the pool, returns once all of them are done
+    void run(size_t tasks, const std::function<void(size_t)> &task);
+
+private:
+    void work(); // worker thread loop
+    void drain(); // running task indices until none are left
+
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex; // guards everything below except m_next
+    std::condition_variable m_start_cv;
+    std::condition_variable m_done_cv;
+    const std::function<void(size_t)> *m_task = nullptr; // current job
+    size_t m_tasks = 0; // number of tasks in the current job
+    std::atomic<size_t> m_next{0}; // next task index to hand out
+    size_t m_active = 0; // workers that have not finished the current job
+    unsigned long m_job = 0; // increases for every job
+    bool m_stop = false;
+};
+
+// default pool size for scanning /proc: a quarter of the online cores, at least one
+size_t defaultScanWorkers();
+
+#endif
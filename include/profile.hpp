@@ -0,0 +1,111 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// stages of producing and drawing a frame, timed on whichever thread runs them
+enum class Stage{
+    // sampler thread
+    CpuStat, // reading and parsing /proc/stat
+    MemInfo, // reading and parsing /proc/meminfo
+    Pressure, // reading and parsing /proc/pressure/{cpu,memory,io}
+    NetDev, // reading and parsing /proc/net/dev
+    ProcEnum, // listing /proc pids
+    StatParse, // reading /proc/<pid>/stat of every pid, merging and evicting
+    CmdlineRead, // reading command lines that were asked for (only timed when some were missing)
+    IoRead, // reading /proc/<pid>/io of the rows on screen and the busiest processes
+    PssRead, // reading /proc/<pid>/smaps_rollup of the rows on screen (only timed when some were stale)
+    Cgroups, // mapping new pids to cgroups and reading each cgroup's accounting (only while grouping)
+    Collect, // copying the process table into the snapshot
+
+    // ui thread
+    Sort, // re-indexing, filtering and ordering the process list
+    DrawCpu,
+    DrawSysInfo,
+    DrawMem,
+    DrawPressure,
+    DrawProc, // sort included
+    DrawMain,
+    Doupdate, // sending the frame to the terminal
+
+    Count
+};
+
+const char *stageName(Stage stage);
+
+// CLOCK_MONOTONIC in nanoseconds, answered by the vDSO without entering the kernel
+uint64_t monotonicNs();
+
+// ─────────────────────────────────────────────
+// Profiler — rolling window of the latest durations of every stage
+// recording is a clock read and a short uncontended lock, cheap enough to stay on all the time
+// ─────────────────────────────────────────────
+class Profiler{
+public:
+    static const size_t WINDOW = 256; // durations kept per stage
+    static const size_t BUCKETS = 24; // log2 histogram buckets: < 1us, < 2us, ... , >= 4s
+
+    struct Summary{
+        size_t count; // durations in the window
+        uint64_t last, p50, p99, max; // ns
+        uint32_t buckets[BUCKETS]; // histogram of the window
+    };
+
+    void record(Stage stage, uint64_t ns);
+    void summarize(Stage stage, Summary &out) const;
+
+private:
+    struct Ring{
+        uint64_t samples[WINDOW] = {};
+        size_t next = 0; // slot the next duration goes to
+        size_t count = 0;
+        uint32_t buckets[BUCKETS] = {}; // kept in step with samples, a rolling histogram
+    };
+
+    static size_t bucket(uint64_t ns);
+
+    mutable std::mutex m_mutex; // guards m_rings, the sampler and ui threads both record
+    Ring m_rings[static_cast<size_t>(Stage::Count)];
+};
+
+// the process-wide profiler every stage records into
+Profiler &profiler();
+
+// timing the enclosing scope as stage
+class StageTimer{
+public:
+    explicit StageTimer(Stage stage) : m_stage(stage), m_start(monotonicNs()){}
+    ~StageTimer(){ profiler().record(m_stage, monotonicNs() - m_start); }
+
+    // to prevent accidental copying
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    Stage m_stage;
+    uint64_t m_start;
+};
+
+// ─────────────────────────────────────────────
+// SelfUsage — vtop's own cpu and memory, from /proc/self/stat
+// ─────────────────────────────────────────────
+class SelfUsage{
+public:
+    // re-reading /proc/self/stat, cpu % is over the time since the previous update
+    void update();
+
+    double cpuPercent() const { return m_cpu_percent; } // 100% = one core
+    unsigned long rssKB() const { return m_rss_kb; }
+    unsigned long threads() const { return m_threads; }
+
+private:
+    unsigned long long m_prev_ticks = 0; // utime + stime
+    uint64_t m_prev_ns = 0;
+    double m_cpu_percent = 0.0;
+    unsigned long m_rss_kb = 0;
+    unsigned long m_threads = 0;
+};
+
+#endif
@@ -1,16 +1,68 @@
 #ifndef READER_H
 #define READER_H
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
-struct CPUStat{
-    std::string cpu;
-    unsigned long long busy;
-    unsigned long long idle;
-    double cpu_usage_percent;
+#include "pool.hpp"
+#include "source.hpp"
 
-    CPUStat(const std::string& c, unsigned long long b, unsigned long long i, double u) : cpu(c), busy(b), idle(i), cpu_usage_percent(u){}
+// time fields of a /proc/stat cpu line, in the order the kernel prints them
+// (guest time is already counted in user, it is kept for display only)
+enum class CpuField{
+    User,
+    Nice,
+    System,
+    Idle,
+    Iowait,
+    Irq,
+    Softirq,
+    Steal,
+    Guest,
+    Count
+};
+
+static const size_t CPU_FIELDS = static_cast<size_t>(CpuField::Count);
+
+// the per-field arrays below are padded with zero rows to a multiple of this, so the delta pass
+// works on whole vectors (8 floats fill an AVX register, 4 an SSE one)
+static const size_t CPU_LANES = 8;
+
+// ─────────────────────────────────────────────
+// CpuCounters — cumulative ticks of every cpu line of /proc/stat, one contiguous array per field
+// row 0 is the aggregate "cpu" line, the cores follow in the order the kernel lists them
+// ─────────────────────────────────────────────
+struct CpuCounters{
+    std::vector<int> ids; // N of every cpuN row, -1 for the aggregate
+    std::vector<unsigned long long> ticks[CPU_FIELDS]; // padded to a multiple of CPU_LANES
+
+    size_t rows() const { return ids.size(); }
+    void clear();
+    void push(int id, const unsigned long long (&fields)[CPU_FIELDS]);
+
+    unsigned long long field(CpuField f, size_t row) const { return ticks[static_cast<size_t>(f)][row]; }
+    unsigned long long total(size_t row) const; // every field but guest
+};
+
+// ─────────────────────────────────────────────
+// CpuUsage — share of every cpu row's time each field took over an interval, in %
+// laid out like CpuCounters, so the panels read a whole field or the busy column contiguously
+// ─────────────────────────────────────────────
+struct CpuUsage{
+    std::vector<int> ids; // N of every cpuN row, -1 for the aggregate
+    std::vector<float> percent[CPU_FIELDS]; // padded to a multiple of CPU_LANES, like every array below
+    std::vector<float> busy; // 100 - idle - iowait, what the bars show
+    std::vector<unsigned long long> elapsed; // ticks the row went through in the interval
+
+    size_t rows() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+    float field(CpuField f, size_t row) const { return percent[static_cast<size_t>(f)][row]; }
 };
 
 struct MemStat{
@@ -24,11 +76,43 @@ struct MemStat{
     double used_percent;
 };
 
+// resources the kernel reports pressure stalls for, one /proc/pressure file each
+enum class PressureResource{
+    Cpu,
+    Memory,
+    Io,
+    Count
+};
+
+static const size_t PRESSURE_RESOURCES = static_cast<size_t>(PressureResource::Count);
+
+// "cpu", "memory" or "io", also the name of its file under /proc/pressure
+const char *pressureResourceName(PressureResource resource);
+
+// one line of a /proc/pressure file: "some" tasks stalled, or "full" (every non-idle task stalled at once)
+struct PressureLine{
+    float avg10 = 0.0f; // % of the last 10s spent stalled, a running average the kernel keeps
+    float avg60 = 0.0f;
+    float avg300 = 0.0f;
+    unsigned long long total_us = 0; // stall time since boot
+    unsigned long long delta_us = 0; // stall time since the previous sample
+    float interval_percent = 0.0f; // delta_us as % of the time since the previous sample
+};
+
+struct PressureStat{
+    bool valid = false; // false without CONFIG_PSI, or when booted with psi=0
+    bool has_full = false; // cpu only reports "full" since 5.13
+    bool has_delta = false; // the previous sample was valid too, so delta_us and interval_percent are set
+    PressureLine some;
+    PressureLine full;
+};
+
 struct ProcStat{
     int pid; // process id
     int ppid; // parent process id
     std::string process_name; // process name
-    std::string command_name; // full command
+    std::string command_name; // full command (empty until requested, see ProcTable::loadCmdlines)
+    bool cmdline_loaded; // whether command_name has been read (it stays empty for kernel threads)
     int threads; // number of threads
 
     // stats
@@ -36,18 +120,242 @@ struct ProcStat{
     unsigned long stime; // system cpu ticks
     unsigned long vsize; // virtual memory (bytes)
     long rss; // resident pages
+    unsigned long long starttime; // start time after boot (ticks)
 
     // derived
-    // double cpu_percent; // cpu %
+    double cpu_percent; // cpu % since the previous sample (100% = one core)
     unsigned long memb_kb; // memb (rss in KB)
+
+    // disk i/o from /proc/<pid>/io, only read for the rows ProcTable::readIo picks
+    unsigned long long read_bytes; // fetched from storage since the process started
+    unsigned long long write_bytes; // sent to storage
+    unsigned long long syscr; // read syscalls
+    unsigned long long syscw; // write syscalls
+    bool io_valid; // whether the rates below are from this sample and the one before
+    double read_rate; // read_bytes per second
+    double write_rate; // write_bytes per second
+    double syscall_rate; // syscr + syscw per second
+
+    // from /proc/<pid>/smaps_rollup, only with pss enabled and only for the rows ProcTable::readPss is given
+    unsigned long pss_kb; // resident pages, each shared one divided among the processes mapping it
+    unsigned long uss_kb; // private resident pages, what exiting would free
+    bool pss_valid; // whether the two above were read (recently, see PSS_MAX_AGE_NS)
+    // (shown next to memb_kb only: rows off screen have no PSS, so sorting and filtering stay on memb_kb)
+
+    int cgroup; // id in the reader's CgroupTable, -1 until read (only while grouping by cgroup)
+};
+
+// counters of one network interface, as /proc/net/dev has them since it came up
+struct NetCounters{
+    unsigned long long rx_bytes = 0;
+    unsigned long long rx_packets = 0;
+    unsigned long long rx_errors = 0;
+    unsigned long long rx_drops = 0;
+    unsigned long long tx_bytes = 0;
+    unsigned long long tx_packets = 0;
+    unsigned long long tx_errors = 0;
+    unsigned long long tx_drops = 0;
+};
+
+// one network interface, its counters and their rates over the last interval
+struct NetStat{
+    std::string name; // "eth0", "veth1a2b3c"
+    NetCounters counters;
+    bool has_rate = false; // it was there in the previous sample too, so the rates below are set
+    double rx_rate = 0.0; // bytes per second
+    double tx_rate = 0.0;
+    double rx_packet_rate = 0.0; // packets per second
+    double tx_packet_rate = 0.0;
+    double drop_rate = 0.0; // received and sent together
+    double error_rate = 0.0;
+};
+
+// one cgroup v2 group, the processes in it summed up next to the cgroup's own accounting
+struct CgroupStat{
+    std::string path; // relative to the cgroup2 mount, "/" for the root
+    size_t procs; // processes in it
+    int threads;
+    double cpu_percent; // summed over its processes (100% = one core)
+    unsigned long memb_kb; // resident memory summed over its processes
+
+    // from its cpu.stat, memory.current and memory.stat, which also count exited children,
+    // page cache and kernel memory, so they cross-check (and usually exceed) the sums above
+    bool cpu_accounted; // whether cpu.stat could be read
+    double usage_percent; // usage_usec over the interval (100% = one core)
+    bool memory_accounted; // whether memory.current could be read (not for the root, nor without the controller)
+    unsigned long long current_kb; // memory.current
+    unsigned long long anon_kb; // anon of memory.stat
+    unsigned long long file_kb; // file of memory.stat (page cache)
 };
 
-std::string getOSTime();
-std::string getOSName();
-std::vector<CPUStat> getIdleAndBusyTime();
-std::vector<CPUStat> calculateDeltaTime(const std::vector<CPUStat> &prevResults, const std::vector<CPUStat> &currResults);
-MemStat getMemInfo();
-int listNumberOfProcDirectories();
+// where ProcTable gets per-process counters from
+enum class ProcBackend{
+    Procfs, // /proc/<pid>/stat, one open per process
+    Taskstats // /proc/<pid>/stat, with cpu times from a netlink TASKSTATS query (needs CAP_NET_ADMIN)
+};
+
+const char *procBackendName(ProcBackend backend);
+
+class TaskstatsClient;
+class CgroupTable;
+class NetTable;
+
+// ─────────────────────────────────────────────
+// ProcTable — persistent pid-keyed process table
+// entries survive across refreshes and the ProcStat storage (strings included)
+// is reused tick after tick; command lines are only read on request, once per pid
+// ─────────────────────────────────────────────
+class ProcTable{
+public:
+    // per-pid files come from source (the running system unless replaying)
+    // workers is the number of threads scanning /proc, 0 picks defaultScanWorkers()
+    // a Taskstats backend falls back to Procfs when netlink queries are not allowed,
+    // and is never used with a source other than liveSource()
+    explicit ProcTable(size_t workers = 0, ProcBackend backend = ProcBackend::Procfs, ProcSource &source = liveSource());
+    ~ProcTable();
+
+    // to prevent accidental copying
+    ProcTable(const ProcTable&) = delete;
+    ProcTable& operator=(const ProcTable&) = delete;
+
+    // re-reading /proc, adding new pids and evicting exited ones
+    // total_ticks is the busy+idle sum of the aggregate "cpu" row of /proc/stat
+    void refresh(unsigned long long total_ticks, size_t num_cpus);
+    void collect(std::vector<ProcStat> &out) const; // copying live entries (unordered)
+
+    // reading the command lines of the given pids that are not cached yet, returns how many were read
+    size_t loadCmdlines(const std::vector<int> &pids);
+
+    // reading /proc/<pid>/io of pids, of the IO_TOP_PROCS busiest processes by cpu and of those
+    // that did i/o in the previous sample, once per refresh at now_ns (the source's clock)
+    // every other row has io_valid false, opening the file for every process would double the scan
+    // returns how many were read
+    size_t readIo(const std::vector<int> &pids, uint64_t now_ns);
+
+    // reading /proc/<pid>/smaps_rollup of pids whose reading is older than PSS_MAX_AGE_NS at now_ns,
+    // the kernel walks every mapping of the process to answer, so this is never done for every row
+    // returns how many were read
+    size_t readPss(const std::vector<int> &pids, uint64_t now_ns);
+
+    // mapping every process whose cgroup is not settled yet to one in cgroups, returns how many were read
+    // a process is looked up when first seen and confirmed once on the next call (container runtimes and
+    // systemd-run --scope move it right after fork), after that it keeps its cgroup without further reads
+    size_t loadCgroups(CgroupTable &cgroups);
+    size_t size() const { return m_size; }
+    ProcBackend backend() const { return m_backend; } // backend actually in use
+
+private:
+    // per-thread results of one scan, new pids only
+    struct ScanChunk{
+        std::vector<ProcStat> fresh; // entries are reused across refreshes
+        size_t fresh_count = 0; // entries filled in this refresh
+        std::unique_ptr<TaskstatsClient> taskstats; // this thread's socket, Taskstats backend only
+    };
+
+    void scanRange(size_t begin, size_t end, ScanChunk &chunk, double ticks_per_cpu);
+    bool readStats(ScanChunk &chunk, int pid, const char *name, ProcStat &ps);
+
+    WorkerPool m_pool; // threads reading per-pid files
+    std::vector<ScanChunk> m_chunks; // one per pool thread
+    std::vector<int> m_pids; // pids found by the current refresh
+    std::vector<ProcStat> m_procs; // live entries first, evicted ones kept after m_size for reuse
+    std::vector<unsigned long> m_last_seen; // refresh tick each slot was last seen in
+    std::vector<unsigned long> m_io_read; // refresh tick each slot's i/o counters were last read in
+    std::vector<unsigned long> m_io_picked; // refresh tick each slot was last picked by readIo
+    std::vector<size_t> m_io_rank; // scratch, slots ordered by cpu to pick the busiest
+    uint64_t m_io_ns = 0; // now_ns of the previous readIo
+    std::vector<uint64_t> m_pss_ns; // when each slot's smaps_rollup was last read, 0 if never
+    std::vector<unsigned char> m_cgroup_loaded; // times each slot's cgroup has been read, up to CGROUP_READS
+    std::unordered_map<int, size_t> m_index; // pid -> slot in m_procs
+    size_t m_size = 0; // number of live entries
+    unsigned long m_tick = 0; // number of refreshes so far
+    unsigned long long m_prev_total_ticks = 0; // total_ticks of the previous refresh
+    ProcSource &m_source; // where per-pid files are read from
+    ProcBackend m_backend;
+};
+
+// times a process's cgroup is read: when it is first seen, and once more to confirm it
+static const unsigned char CGROUP_READS = 2;
+
+// processes whose disk i/o is read every sample besides the ones on screen, by cpu
+static const size_t IO_TOP_PROCS = 32;
+
+// how long a PSS reading is kept before smaps_rollup is read again
+static const uint64_t PSS_MAX_AGE_NS = 5000000000;
+
+// one sample of the whole system, every kernel source read at most once to build it
+struct SystemSnapshot{
+    CpuUsage cpu; // per-core utilization over the last interval (the aggregate row first)
+    MemStat mem; // memory usage
+    std::array<PressureStat, PRESSURE_RESOURCES> pressure; // stalls, indexed by PressureResource
+    std::vector<NetStat> net; // network interfaces, in the order the kernel lists them
+    std::vector<ProcStat> procs; // processes, in no particular order
+    std::vector<CgroupStat> cgroups; // only while grouping by cgroup, in no particular order
+    size_t num_cpus; // cores, from the same /proc/stat read as cpu
+    size_t num_procs; // processes, from the same /proc scan as procs
+    ProcBackend backend; // where the process counters came from
+    std::string os_name; // PRETTY_NAME from /etc/os-release
+    std::time_t time; // when the sample was taken
+    unsigned long sample; // increases by one for every sample, snapshots republished with command lines keep it
+    unsigned long generation; // increases by one for every published snapshot
+};
+
+// ─────────────────────────────────────────────
+// SystemReader — produces SystemSnapshots
+// keeps whatever has to survive between samples (previous cpu counters, process table)
+// ─────────────────────────────────────────────
+class SystemReader{
+public:
+    // pss turns on reading smaps_rollup of the rows on screen, for their PSS and USS
+    explicit SystemReader(size_t scan_workers = 0, ProcBackend backend = ProcBackend::Procfs, ProcSource &source = liveSource(), bool pss = false);
+    ~SystemReader();
+
+    // taking a full sample into out, reading the command lines of cmdline_pids that are not cached
+    // and the disk i/o (and PSS) of shown_pids, the rows on screen (see ProcTable::readIo and readPss)
+    // the first sample reports cpu utilization since boot
+    void sample(SystemSnapshot &out, const std::vector<int> &cmdline_pids, const std::vector<int> &shown_pids);
+
+    // grouping processes by cgroup from the next sample on, or no longer
+    void groupCgroups(bool enabled);
+
+    // reading missing command lines of cmdline_pids without taking a new sample,
+    // returns false if they were all cached, otherwise out is latest with the command lines filled in
+    bool loadCmdlines(const std::vector<int> &cmdline_pids, const SystemSnapshot &latest, SystemSnapshot &out);
+
+private:
+    ProcSource &m_source; // system-wide files
+    ProcTable m_proc_table; // processes, kept across samples
+    CpuCounters m_prev_cpu; // cpu counters of the previous sample
+    CpuCounters m_curr_cpu; // and of this one, swapped after every sample so neither reallocates
+    std::string m_os_name; // does not change while running, read once
+    unsigned long m_samples = 0; // samples taken so far
+    bool m_pss; // whether shown rows get their PSS read
+    std::array<PressureStat, PRESSURE_RESOURCES> m_prev_pressure; // pressure of the previous sample
+    uint64_t m_pressure_ns = 0; // when it was read
+    std::unique_ptr<NetTable> m_net; // interface counters of the previous sample
+    std::unique_ptr<CgroupTable> m_cgroups; // created the first time grouping is turned on
+    bool m_group_cgroups = false;
+};
+
+std::string getOSTime(std::time_t time);
+std::string getOSName(ProcSource &source = liveSource());
+bool readCpuCounters(ProcSource &source, CpuCounters &out); // false if /proc/stat could not be read
+// usage between two reads of the counters, since boot if prev has no rows or a different set of them
+void computeCpuUsage(const CpuCounters &prev, const CpuCounters &curr, CpuUsage &out);
+MemStat getMemInfo(ProcSource &source = liveSource());
+bool parsePressure(const char *buf, size_t len, PressureStat &out); // contents of a /proc/pressure file, averages and totals only
+bool readPressure(ProcSource &source, PressureResource resource, PressureStat &out);
+// stall time between two readings of a resource elapsed_ns apart, into curr
+void computePressureDelta(const PressureStat &prev, PressureStat &curr, uint64_t elapsed_ns);
+
+// per-pid readers, nothing is allocated unless the command line outgrows the string's capacity
+bool parseProcStat(const char *buf, size_t len, ProcStat& ps); // contents of /proc/<pid>/stat
+bool readProcStat(ProcSource &source, const char *pid, ProcStat& ps);
+bool readCmdLine(ProcSource &source, const char *pid, std::string &cmdline);
+bool parseProcIo(const char *buf, size_t len, ProcStat &ps); // contents of /proc/<pid>/io, counters only
+bool readProcIo(ProcSource &source, const char *pid, ProcStat &ps);
+bool parseSmapsRollup(const char *buf, size_t len, ProcStat &ps); // contents of /proc/<pid>/smaps_rollup
+bool readSmapsRollup(ProcSource &source, const char *pid, ProcStat &ps);
 std::vector<ProcStat> getProcStats();
 
 #endif
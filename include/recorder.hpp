@@ -0,0 +1,70 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "options.hpp"
+#include "reader.hpp"
+
+// ─────────────────────────────────────────────
+// Recording file format
+//
+// "VTOPREC" + version byte, then frames appended one after another:
+//   varint body length, body
+// body:
+//   u8 flags (FRAME_KEY: everything below is relative to zero instead of the previous frame)
+//   varint time (ms since epoch on key frames, ms since the previous frame otherwise)
+//   varint cpu rows, per row zigzag(busy delta), zigzag(idle delta)
+//   zigzag deltas of MemTotal, MemFree, MemAvailable, Buffers, Cached (KB)
+//   varint process count, per process (sorted by pid):
+//     varint pid delta from the previous process in the frame
+//     u8 mask, PROC_NEW for processes absent from the previous frame (or whose pid was reused),
+//       otherwise one bit per field below that changed
+//     new: zigzag ppid, starttime, utime, stime, threads, vsize, rss, varint name length, name
+//     known: zigzag deltas of the changed fields (ppid, utime, stime, threads, vsize, rss),
+//       then the new name (varint length, name) if the process renamed itself
+// processes missing from a frame have exited; command lines are not recorded
+// ─────────────────────────────────────────────
+
+// raw counters of one recorded sample
+struct RecordFrame{
+    uint64_t time_ms; // ms since epoch
+    bool key; // written as a key frame
+    CpuCounters cpu; // cumulative ticks (aggregate first), only busy and idle are recorded
+    MemStat mem;
+    std::vector<ProcStat> procs; // sorted by pid
+};
+
+// turning frames into delta encoded bytes, keeps the previous frame to diff against
+class RecordEncoder{
+public:
+    // appending the encoded frame (length prefix included) to out
+    void encode(const RecordFrame &frame, bool key, std::string &out);
+
+private:
+    RecordFrame m_prev;
+    bool m_has_prev = false;
+    std::string m_body; // scratch for the frame being encoded, keeps its capacity between frames
+};
+
+// reading frames back, keeps the previous frame to apply deltas to
+class RecordDecoder{
+public:
+    // decoding the frame at data[pos], advancing pos, returns false at the end or on corrupt data
+    bool decode(const std::string &data, size_t &pos, RecordFrame &frame);
+
+private:
+    RecordFrame m_prev;
+    bool m_has_prev = false;
+};
+
+// headless mode: sampling every interval and appending frames to path until SIGINT/SIGTERM
+int runRecorder(const std::string &path, std::chrono::milliseconds interval, const Options &options);
+
+// printing a recording as text, one line per frame
+int dumpRecording(const std::string &path);
+
+#endif
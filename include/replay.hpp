@@ -0,0 +1,155 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "reader.hpp"
+#include "source.hpp"
+
+// ─────────────────────────────────────────────
+// Capture archive format
+//
+// the raw contents of every file the readers parse, one frame per sample, integers in host byte order
+// (system-wide: stat, meminfo, net/dev and the pressure files the kernel has, per process: stat, cmdline and io,
+// the last one only where it was readable)
+//
+// "VTOPCAP" + version byte, then frames:
+//   u32 body size, body:
+//     u64 time (ms since epoch), u8 flags (FRAME_KEY), u32 file count, per file:
+//       u8 kind, u16 path length, path (relative to /proc, "os-release" for /etc/os-release)
+//       FILE_DATA: u32 size, contents
+//       FILE_SAME: nothing, the contents are the previous frame's (never in key frames)
+// files missing from a frame did not exist when it was taken (exited processes)
+//
+// written when the capture stops, missing if it was killed (frames are then scanned on open):
+//   u32 INDEX_MARKER, u32 frame count, u32 key frame count, per key frame: u32 frame number, u64 offset
+//   u64 offset of INDEX_MARKER, "VTOPIDX\0"
+// ─────────────────────────────────────────────
+
+// headless mode: capturing raw /proc contents every interval into path until SIGINT/SIGTERM
+int runCapture(const std::string &path, std::chrono::milliseconds interval);
+
+// ─────────────────────────────────────────────
+// ReplaySource — serves the files of one frame of a capture archive,
+// the archive is mmap'd and contents are never copied until read
+// ─────────────────────────────────────────────
+class ReplaySource : public ProcSource{
+public:
+    ReplaySource() = default;
+    ~ReplaySource() override;
+
+    // to prevent accidental copying
+    ReplaySource(const ReplaySource&) = delete;
+    ReplaySource& operator=(const ReplaySource&) = delete;
+
+    // mapping the archive and loading (or rebuilding) its key frame index, false with a reason in error
+    bool open(const std::string &path, std::string &error);
+
+    // positioning on frame (0 .. frames()-1), decoding forward from the nearest key frame
+    bool load(size_t frame);
+
+    size_t frames() const { return m_frame_count; }
+    size_t frame() const { return m_frame; } // frame currently served
+    uint64_t frameTimeMs() const { return m_time_ms; }
+    // time of the frame after the current one, 0 at the end
+    uint64_t nextFrameTimeMs() const;
+
+    ssize_t read(const char *path, char *buf, size_t size) override;
+    bool read(const char *path, std::string &out) override;
+    void listPids(std::vector<int> &pids) override;
+    bool readOSRelease(std::string &out) override;
+    std::time_t now() override;
+    uint64_t clockNs() override; // the frame's capture time, gaps between frames are as recorded
+
+private:
+    struct File{
+        std::string_view path;
+        std::string_view data; // points into the mapping
+    };
+
+    struct KeyFrame{
+        uint32_t frame;
+        uint64_t offset;
+    };
+
+    bool readIndex();
+    bool scanFrames();
+    // decoding the frame at offset on top of m_files, advancing offset past it
+    bool decodeFrame(uint64_t &offset);
+    static const File *find(const std::vector<File> &files, std::string_view path);
+
+    const char *m_data = nullptr; // the mapping
+    size_t m_size = 0;
+    uint64_t m_frames_end = 0; // where the frames stop (the index, or the end of the file)
+
+    std::vector<KeyFrame> m_keys; // ascending
+    size_t m_frame_count = 0;
+
+    std::vector<File> m_files; // files of the current frame, sorted by path
+    std::vector<File> m_prev_files; // files of the frame before, reused as decode scratch
+    size_t m_frame = 0;
+    bool m_loaded = false;
+    uint64_t m_time_ms = 0;
+    uint64_t m_next_offset = 0; // offset of the frame after m_frame
+};
+
+// ─────────────────────────────────────────────
+// Replayer — plays a capture archive through SystemReader,
+// producing the same SystemSnapshots the Sampler does for the live system
+// ─────────────────────────────────────────────
+class Replayer{
+public:
+    Replayer() = default;
+
+    // to prevent accidental copying
+    Replayer(const Replayer&) = delete;
+    Replayer& operator=(const Replayer&) = delete;
+
+    // opening the archive and showing its first frame, false with a reason in error
+    bool open(const std::string &path, std::string &error);
+
+    // snapshot of the current frame
+    std::shared_ptr<const SystemSnapshot> latest() const { return m_latest; }
+
+    // same contract as Sampler::requestCmdlines(), served immediately
+    void requestCmdlines(const std::vector<int> &pids);
+
+    // same contract as Sampler::requestShown(), from the next frame on
+    void requestShown(const std::vector<int> &pids);
+
+    // moving on to the next frame if it is due, returns true if the snapshot or status changed
+    bool update();
+
+    // milliseconds until update() has the next frame to show, -1 while paused
+    int msUntilDue() const;
+
+    void togglePause();
+    void step(long frames); // jumping frames forward or back, pauses playback
+    void seek(long frames); // jumping frames forward or back, keeps playing
+    void cycleSpeed(); // 1x, 2x, 4x, ... fast-forward
+
+    // "replay 12/340 | playing 4x" for the status line
+    std::string status() const;
+
+private:
+    bool show(size_t frame);
+    void schedule();
+
+    ReplaySource m_source;
+    std::unique_ptr<SystemReader> m_reader; // rebuilt on every jump so cpu deltas stay correct
+    std::vector<int> m_cmdline_pids; // latest requestCmdlines() pids
+    std::vector<int> m_shown_pids; // latest requestShown() pids
+    std::shared_ptr<const SystemSnapshot> m_latest;
+    unsigned long m_generation = 0;
+
+    bool m_paused = false;
+    unsigned m_speed = 1;
+    std::chrono::steady_clock::time_point m_due; // when the next frame is shown
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "events.hpp"
+#include "reader.hpp"
+
+// ─────────────────────────────────────────────
+// Sampler — background thread that owns all /proc reads
+// and publishes snapshots at a fixed cadence, kept by a timerfd
+// ─────────────────────────────────────────────
+class Sampler{
+public:
+    // scan_workers is the number of threads reading /proc, 0 picks the default
+    // pss reads smaps_rollup for the rows on screen (see SystemReader)
+    Sampler(std::chrono::milliseconds interval, size_t scan_workers = 0, ProcBackend backend = ProcBackend::Procfs, bool pss = false);
+    ~Sampler();
+
+    // to prevent accidental copying
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+
+    void start(); // starting the sampling thread
+    void stop(); // stopping and joining the sampling thread
+
+    // latest published snapshot (nullptr until the first sample is taken)
+    std::shared_ptr<const SystemSnapshot> latest() const;
+
+    // blocks until the first snapshot has been published
+    std::shared_ptr<const SystemSnapshot> waitForFirst() const;
+
+    // readable once a snapshot has been published since the last clearPublished(), for the ui's poll()
+    int publishedFd() const { return m_published.fd(); }
+    void clearPublished() { m_published.drain(); }
+
+    // pids whose command lines the ui is about to show (visible rows plus a prefetch window),
+    // missing ones are read right away and the latest snapshot republished with them
+    void requestCmdlines(const std::vector<int> &pids);
+
+    // pids of the rows on screen, whose disk i/o (and PSS, if enabled) is read from the next sample on
+    void requestShown(const std::vector<int> &pids);
+
+    // grouping processes by cgroup (SystemSnapshot::cgroups) from the next sample on, or no longer
+    void requestCgroups(bool enabled);
+
+private:
+    void run(); // sampling loop
+    void publish(std::shared_ptr<SystemSnapshot> snapshot);
+    std::shared_ptr<SystemSnapshot> acquireBuffer();
+    void takeCmdlineRequest();
+    void takeShownRequest();
+    void takeCgroupRequest();
+    void publishCmdlines();
+
+    std::chrono::milliseconds m_interval; // time between two samples
+    SystemReader m_reader; // reads every kernel source once per sample
+    IntervalTimer m_timer; // ticks when the next sample is due
+    Waker m_requests; // wakes the sampling thread for command line requests and stop()
+    Waker m_published; // wakes the ui when a snapshot is published
+    std::vector<int> m_cmdline_pids; // pids whose command lines are wanted
+    std::vector<int> m_shown_pids; // pids on screen, whose disk i/o and PSS are wanted
+    unsigned long m_generation = 0;
+
+    // where a snapshot's buffer goes when its last reference is dropped, reused for the next sample
+    struct SnapshotPool{
+        std::mutex mutex;
+        std::unique_ptr<SystemSnapshot> spare;
+    };
+    std::shared_ptr<SnapshotPool> m_pool; // shared with the deleter of every snapshot handed out
+
+    mutable std::mutex m_mutex; // guards everything below
+    mutable std::condition_variable m_cv; // for waitForFirst()
+    std::shared_ptr<const SystemSnapshot> m_latest; // snapshot handed to the ui
+    std::vector<int> m_cmdline_request; // latest requestCmdlines() pids, not taken over yet
+    bool m_cmdlines_requested = false;
+    std::vector<int> m_shown_request; // latest requestShown() pids, not taken over yet
+    bool m_shown_requested = false;
+    bool m_group_cgroups = false; // latest requestCgroups()
+    bool m_stop = false;
+
+    std::thread m_thread;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "reader.hpp"
+
+// ─────────────────────────────────────────────
+// ProcFilter — what the process list is narrowed down to
+// parsed from the search prompt, space separated terms that must all match:
+//   word        name contains word (case-insensitive)
+//   cmd:regex   command line matches regex (case-insensitive)
+//   pid:N       pid is N
+//   ppid:N      parent pid is N
+//   mem:N       at least N KB of resident memory, N may end in k, m or g
+// ─────────────────────────────────────────────
+struct ProcFilter{
+    std::vector<std::string> names; // lowercased substrings
+    std::vector<std::regex> commands;
+    int pid = -1; // -1 matches any
+    int ppid = -1;
+    unsigned long min_mem_kb = 0;
+
+    bool empty() const { return names.empty() && commands.empty() && pid < 0 && ppid < 0 && min_mem_kb == 0; }
+    bool needsCmdlines() const { return !commands.empty(); } // command lines are read lazily otherwise
+};
+
+// parsing text into filter, false with the offending term in error
+// (filter then holds every term that did parse)
+bool parseProcFilter(const std::string &text, ProcFilter &filter, std::string &error);
+
+// ─────────────────────────────────────────────
+// ProcSearchIndex — lowercased names and command lines of every process, back to back in one buffer
+// kept in step with the snapshots: only new pids, renamed processes and freshly read command lines
+// are appended, so matching is a linear pass over contiguous memory with no per-process strings
+// ─────────────────────────────────────────────
+class ProcSearchIndex{
+public:
+    // bringing the index in line with procs, which the next match() calls refer to
+    void update(const std::vector<ProcStat> &procs);
+
+    // indices into procs of the processes matching filter, in procs order
+    void match(const std::vector<ProcStat> &procs, const ProcFilter &filter, std::vector<int> &out) const;
+
+private:
+    struct Entry{
+        uint32_t name_offset, name_length; // into m_text
+        uint32_t cmd_offset, cmd_length; // empty until the command line is read
+        unsigned long long starttime; // a different start time is a new process reusing the pid
+        unsigned long seen; // update() tick the pid was last seen in
+    };
+
+    uint32_t append(const std::string &text); // appending text lowercased, returns its offset
+    void compact(); // dropping text no longer referenced once it makes up half the buffer
+
+    std::string m_text; // lowercased names and command lines
+    std::string m_scratch; // compaction target, swapped with m_text
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_free; // entry slots of exited processes, reused first
+    std::unordered_map<int, uint32_t> m_slots; // pid -> entry
+    std::vector<uint32_t> m_rows; // entry of each proc passed to the last update()
+    size_t m_garbage = 0; // bytes of m_text nothing refers to any more
+    unsigned long m_tick = 0;
+};
+
+#endif
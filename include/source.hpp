@@ -0,0 +1,75 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// ─────────────────────────────────────────────
+// ProcSource — where the readers get raw kernel file contents from
+// paths are relative to /proc ("stat", "meminfo", "42/stat", "42/cmdline"),
+// read() and listPids() may be called from several scan threads at once
+// ─────────────────────────────────────────────
+class ProcSource{
+public:
+    virtual ~ProcSource() = default;
+
+    // reading a whole (small) file into buf, returns the number of bytes read or -1
+    virtual ssize_t read(const char *path, char *buf, size_t size) = 0;
+
+    // reading a whole file of any size into out, reusing its capacity
+    virtual bool read(const char *path, std::string &out) = 0;
+
+    // listing the pids of running processes into pids
+    virtual void listPids(std::vector<int> &pids) = 0;
+
+    // contents of /etc/os-release
+    virtual bool readOSRelease(std::string &out) = 0;
+
+    // wall clock time the contents belong to
+    virtual std::time_t now() = 0;
+
+    // monotonic time the contents belong to (ns), what per-second rates are computed over
+    virtual uint64_t clockNs() = 0;
+};
+
+// ─────────────────────────────────────────────
+// ProcfsSource — the running system, files opened relative to one /proc fd
+// system-wide files read every sample stay open and are re-read with pread at offset 0
+// ─────────────────────────────────────────────
+class ProcfsSource : public ProcSource{
+public:
+    // root is normally /proc, benchmarks point it at a fixture tree of the same layout
+    explicit ProcfsSource(const char *root = "/proc");
+    ~ProcfsSource() override;
+
+    // to prevent accidental copying
+    ProcfsSource(const ProcfsSource&) = delete;
+    ProcfsSource& operator=(const ProcfsSource&) = delete;
+
+    ssize_t read(const char *path, char *buf, size_t size) override;
+    bool read(const char *path, std::string &out) override;
+    void listPids(std::vector<int> &pids) override;
+    bool readOSRelease(std::string &out) override;
+    std::time_t now() override;
+    uint64_t clockNs() override;
+
+private:
+    // fd of path if it is one of the persistent files, -1 otherwise
+    int persistentFd(const char *path) const;
+
+    struct PersistentFile{
+        const char *path;
+        int fd;
+    };
+
+    int m_proc_fd; // /proc directory fd
+    std::vector<PersistentFile> m_persistent; // opened once, never closed while running
+};
+
+// the running system, shared by every reader not given another source
+ProcSource &liveSource();
+
+#endif
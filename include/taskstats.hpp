@@ -0,0 +1,43 @@
+#ifndef TASKSTATS_H
+#define TASKSTATS_H
+
+#include <cstdint>
+
+#include "reader.hpp"
+
+// ─────────────────────────────────────────────
+// TaskstatsClient — per-task cpu accounting over the netlink TASKSTATS
+// generic netlink family, microsecond totals of the whole thread group
+// the kernel only answers CAP_NET_ADMIN callers, so open() fails when unprivileged
+// ─────────────────────────────────────────────
+class TaskstatsClient{
+public:
+    TaskstatsClient() = default;
+    ~TaskstatsClient();
+
+    // to prevent accidental copying
+    TaskstatsClient(const TaskstatsClient&) = delete;
+    TaskstatsClient& operator=(const TaskstatsClient&) = delete;
+
+    // opening the socket, resolving the family and checking that queries are allowed
+    bool open();
+
+    // filling utime/stime of ps with the cpu time of the whole thread group of pid, in clock ticks;
+    // everything else comes from /proc/<pid>/stat (taskstats only has peak memory, no thread count
+    // and a start time in whole seconds)
+    bool read(int pid, ProcStat &ps);
+
+private:
+    // sending one TASKSTATS_CMD_GET for a pid or tgid and receiving the reply into m_buf,
+    // returns the reply length or -1
+    int query(uint16_t attr, uint32_t id);
+    // finding the struct taskstats in the reply in m_buf
+    const void *findStats(int len, uint16_t aggr_type) const;
+
+    int m_fd = -1;
+    uint16_t m_family = 0; // resolved TASKSTATS family id
+    uint32_t m_seq = 0;
+    alignas(4) char m_buf[2048]; // reply buffer, reused for every query
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+// what cores are grouped by in the compact cpu panel
+enum class CpuGrouping{
+    Auto, // numa nodes if there are several, else sockets if there are several, else none
+    Node,
+    Socket,
+    None
+};
+
+// ─────────────────────────────────────────────
+// CpuTopology — socket and numa node of every core, from /sys/devices/system/cpu
+// read once at startup, cores are indexed by their number (cpuN), -1 where unknown
+// ─────────────────────────────────────────────
+struct CpuTopology{
+    std::vector<int> socket; // topology/physical_package_id
+    std::vector<int> node; // the nodeN link in the core's directory
+
+    // group of core cpu under grouping (resolved, not Auto), -1 if it has none
+    int group(CpuGrouping grouping, int cpu) const;
+
+    // Auto turned into the grouping it stands for on this machine
+    CpuGrouping resolve(CpuGrouping grouping) const;
+};
+
+// reading the topology under root, empty if root cannot be read (a container without /sys)
+CpuTopology readCpuTopology(const char *root = "/sys/devices/system/cpu");
+
+// "node", "socket" or "none"
+const char *cpuGroupingName(CpuGrouping grouping);
+
+#endif
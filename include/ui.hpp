@@ -1,6 +1,9 @@
 #ifndef UI_H
 #define UI_H
 
-void draw();
+#include "options.hpp"
+
+// drawing until the user quits, returns the exit status
+int draw(const Options &options);
 
 #endif
@@ -0,0 +1,232 @@
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../include/cgroup.hpp"
+
+// the value of the "key value" line starting with key (key includes the space), false if there is none
+static bool findValue(const char *buf, size_t len, const char *key, unsigned long long &value){
+    size_t key_len = std::strlen(key);
+    const char *p = buf;
+    const char *end = buf + len;
+    while (p < end){
+        const char *newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char *line_end = newline ? newline : end;
+
+        if (static_cast<size_t>(line_end - p) > key_len && std::memcmp(p, key, key_len) == 0){
+            return std::from_chars(p + key_len, line_end, value).ec == std::errc();
+        }
+
+        p = line_end + 1;
+    }
+    return false;
+}
+
+CgroupTable::CgroupTable(const char *root)
+    : m_root_fd(open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC))
+{
+    // a hybrid systemd layout mounts v1 controllers at the root and the v2 hierarchy under "unified"
+    if (m_root_fd >= 0 && faccessat(m_root_fd, "cgroup.controllers", F_OK, 0) != 0){
+        int unified = openat(m_root_fd, "unified", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (unified >= 0){
+            close(m_root_fd);
+            m_root_fd = unified;
+        }
+    }
+}
+
+CgroupTable::~CgroupTable(){
+    if (m_root_fd >= 0){
+        close(m_root_fd);
+    }
+}
+
+int CgroupTable::intern(const char *path, size_t len){
+    m_path.assign(path, len);
+    auto it = m_ids.find(m_path);
+    if (it != m_ids.end()){
+        return it->second;
+    }
+
+    // reusing the id of a cgroup that was forgotten, containers come and go
+    int id;
+    if (!m_free.empty()){
+        id = m_free.back();
+        m_free.pop_back();
+    } else {
+        id = static_cast<int>(m_entries.size());
+        m_entries.emplace_back();
+    }
+
+    Entry &entry = m_entries[id];
+    entry.path = m_path;
+    entry.prev_usage_usec = 0;
+    entry.prev_ns = 0;
+    m_ids.emplace(m_path, id);
+    return id;
+}
+
+ssize_t CgroupTable::readFile(const std::string &path, const char *file, char *buf, size_t size){
+    if (m_root_fd < 0){
+        return -1;
+    }
+
+    // relative to the mount, the root cgroup's files are right in it
+    size_t start = path.find_first_not_of('/');
+    m_path.clear();
+    if (start != std::string::npos){
+        m_path.assign(path, start);
+        m_path.push_back('/');
+    }
+    m_path.append(file);
+
+    int fd = openat(m_root_fd, m_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0){
+        return -1;
+    }
+
+    size_t total = 0;
+    while (total < size){
+        ssize_t n = ::read(fd, buf + total, size - total);
+        if (n < 0 && errno == EINTR){
+            continue;
+        }
+        if (n <= 0){
+            break;
+        }
+        total += n;
+    }
+    close(fd);
+    return static_cast<ssize_t>(total);
+}
+
+void CgroupTable::readAccounting(Entry &entry, uint64_t now_ns, CgroupStat &stat){
+    stat.cpu_accounted = false;
+    stat.memory_accounted = false;
+    stat.usage_percent = 0.0;
+    stat.current_kb = stat.anon_kb = stat.file_kb = 0;
+
+    // memory.stat runs to a few KB on recent kernels
+    char buf[8192];
+    unsigned long long value;
+
+    // cpu time of every task that ever ran in it, so the rate also counts children that already exited
+    ssize_t len = readFile(entry.path, "cpu.stat", buf, sizeof(buf));
+    if (len > 0 && findValue(buf, len, "usage_usec ", value)){
+        if (entry.prev_ns > 0 && now_ns > entry.prev_ns && value >= entry.prev_usage_usec){
+            stat.usage_percent = 100.0 * (value - entry.prev_usage_usec) * 1000.0 / (now_ns - entry.prev_ns);
+        }
+        entry.prev_usage_usec = value;
+        entry.prev_ns = now_ns;
+        stat.cpu_accounted = true;
+    }
+
+    // charged memory, page cache and kernel memory included (none of it for the root cgroup)
+    len = readFile(entry.path, "memory.current", buf, sizeof(buf));
+    if (len > 0 && std::from_chars(buf, buf + len, value).ec == std::errc()){
+        stat.current_kb = value / 1024;
+        stat.memory_accounted = true;
+
+        len = readFile(entry.path, "memory.stat", buf, sizeof(buf));
+        if (len > 0){
+            if (findValue(buf, len, "anon ", value)){
+                stat.anon_kb = value / 1024;
+            }
+            if (findValue(buf, len, "file ", value)){
+                stat.file_kb = value / 1024;
+            }
+        }
+    }
+}
+
+void CgroupTable::aggregate(const std::vector<ProcStat> &procs, uint64_t now_ns, std::vector<CgroupStat> &out){
+    for (Entry &entry : m_entries){
+        entry.row = -1;
+    }
+
+    // one pass over the processes, each cgroup gets a row the first time one of them is seen
+    size_t rows = 0;
+    for (const ProcStat &ps : procs){
+        if (ps.cgroup < 0 || static_cast<size_t>(ps.cgroup) >= m_entries.size() || m_entries[ps.cgroup].path.empty()){
+            continue;
+        }
+
+        Entry &entry = m_entries[ps.cgroup];
+        if (entry.row < 0){
+            if (rows == out.size()){
+                out.emplace_back();
+            }
+            entry.row = static_cast<long>(rows++);
+
+            CgroupStat &stat = out[entry.row];
+            stat.path = entry.path; // keeps the row's string capacity
+            stat.procs = 0;
+            stat.threads = 0;
+            stat.cpu_percent = 0.0;
+            stat.memb_kb = 0;
+        }
+
+        CgroupStat &stat = out[entry.row];
+        ++stat.procs;
+        stat.threads += ps.threads;
+        stat.cpu_percent += ps.cpu_percent;
+        stat.memb_kb += ps.memb_kb;
+    }
+    out.resize(rows);
+
+    // the cgroup's own view, and forgetting the ones nothing runs in any more
+    // (no process references them, so their ids are free to hand out again)
+    for (size_t id = 0; id < m_entries.size(); ++id){
+        Entry &entry = m_entries[id];
+        if (entry.row >= 0){
+            readAccounting(entry, now_ns, out[entry.row]);
+        } else if (!entry.path.empty()){
+            m_ids.erase(entry.path);
+            entry.path.clear();
+            m_free.push_back(static_cast<int>(id));
+        }
+    }
+}
+
+bool parsePidCgroup(const char *buf, size_t len, const char *&path, size_t &path_len){
+    // "hierarchy:controllers:path" lines, the unified hierarchy is "0::/path"
+    const char *p = buf;
+    const char *end = buf + len;
+    while (p < end){
+        const char *newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char *line_end = newline ? newline : end;
+
+        if (line_end - p > 3 && std::memcmp(p, "0::", 3) == 0){
+            path = p + 3;
+            path_len = line_end - path;
+            return true;
+        }
+
+        p = line_end + 1;
+    }
+    return false;
+}
+
+int readPidCgroup(ProcSource &source, const char *pid, CgroupTable &cgroups){
+    char path[32];
+    if (std::snprintf(path, sizeof(path), "%s/cgroup", pid) >= static_cast<int>(sizeof(path))){
+        return -1;
+    }
+
+    // one line on a pure v2 system, one per v1 hierarchy besides it on a hybrid one
+    char buf[2048];
+    ssize_t len = source.read(path, buf, sizeof(buf));
+    if (len <= 0){
+        return -1;
+    }
+
+    const char *cgroup;
+    size_t cgroup_len;
+    if (!parsePidCgroup(buf, len, cgroup, cgroup_len)){
+        return -1; // v1 only, nothing to group by
+    }
+    return cgroups.intern(cgroup, cgroup_len);
+}
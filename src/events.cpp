@@ -0,0 +1,122 @@
+#include <cerrno>
+#include <csignal>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "../include/events.hpp"
+
+// ─────────────────────────────────────────────
+// IntervalTimer
+// ─────────────────────────────────────────────
+
+IntervalTimer::IntervalTimer()
+    : m_fd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)){}
+
+IntervalTimer::~IntervalTimer(){
+    if (m_fd >= 0){
+        close(m_fd);
+    }
+}
+
+bool IntervalTimer::start(std::chrono::nanoseconds interval){
+    if (m_fd < 0 || interval.count() <= 0){
+        return false;
+    }
+
+    itimerspec spec{};
+    spec.it_interval.tv_sec = static_cast<time_t>(interval.count() / 1000000000);
+    spec.it_interval.tv_nsec = static_cast<long>(interval.count() % 1000000000);
+    spec.it_value = spec.it_interval;
+    return timerfd_settime(m_fd, 0, &spec, nullptr) == 0;
+}
+
+uint64_t IntervalTimer::consume(){
+    uint64_t ticks = 0;
+    if (m_fd < 0 || read(m_fd, &ticks, sizeof(ticks)) != sizeof(ticks)){
+        return 0;
+    }
+    return ticks;
+}
+
+// ─────────────────────────────────────────────
+// Waker
+// ─────────────────────────────────────────────
+
+Waker::Waker()
+    : m_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)){}
+
+Waker::~Waker(){
+    if (m_fd >= 0){
+        close(m_fd);
+    }
+}
+
+void Waker::notify(){
+    uint64_t one = 1;
+    if (m_fd >= 0 && write(m_fd, &one, sizeof(one)) < 0){
+        // only fails once the counter is close to overflowing, the fd is readable either way
+    }
+}
+
+void Waker::drain(){
+    uint64_t count;
+    if (m_fd >= 0 && read(m_fd, &count, sizeof(count)) < 0){
+        // nothing was pending
+    }
+}
+
+// ─────────────────────────────────────────────
+// SignalWatch
+// ─────────────────────────────────────────────
+
+SignalWatch::SignalWatch(std::initializer_list<int> signals){
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (int sig : signals){
+        sigaddset(&mask, sig);
+    }
+
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+    m_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+}
+
+SignalWatch::~SignalWatch(){
+    if (m_fd >= 0){
+        close(m_fd);
+    }
+}
+
+int SignalWatch::next(){
+    signalfd_siginfo info;
+    if (m_fd < 0 || read(m_fd, &info, sizeof(info)) != sizeof(info)){
+        return 0;
+    }
+    return static_cast<int>(info.ssi_signo);
+}
+
+int waitForEvents(pollfd *fds, size_t count, int timeout_ms){
+    while (true){
+        int ready = poll(fds, count, timeout_ms);
+        if (ready >= 0 || errno != EINTR){
+            return ready;
+        }
+    }
+}
+
+int waitForTick(IntervalTimer &timer, SignalWatch &signals){
+    pollfd fds[] = {{timer.fd(), POLLIN, 0}, {signals.fd(), POLLIN, 0}};
+    while (true){
+        if (waitForEvents(fds, 2, -1) < 0){
+            return -1;
+        }
+        if (signals.next() != 0){
+            return 0;
+        }
+        if (timer.consume() > 0){
+            return 1;
+        }
+    }
+}
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <limits>
+
+#include "../include/history.hpp"
+
+static const float MISSING = std::numeric_limits<float>::quiet_NaN();
+
+// processes the ranking scratch has room for from the start
+static const size_t RESERVED_PROCS = 4096;
+
+History::History(size_t capacity, size_t cpus, size_t top_procs)
+    : m_capacity(std::max<size_t>(capacity, 1)),
+      m_cores(cpus + 1),
+      m_top(top_procs),
+      m_core_usage(m_cores * m_capacity, MISSING),
+      m_mem(static_cast<size_t>(MemSeries::Count) * m_capacity, MISSING),
+      m_slots(2 * top_procs),
+      m_proc_cpu(m_slots.size() * m_capacity, MISSING),
+      m_proc_rss_kb(m_slots.size() * m_capacity, MISSING)
+{
+    m_order.reserve(RESERVED_PROCS);
+    m_tracked.reserve(m_slots.size());
+}
+
+int History::findSlot(int pid) const{
+    for (size_t s = 0; s < m_slots.size(); ++s){
+        if (m_slots[s].pid == pid){
+            return static_cast<int>(s);
+        }
+    }
+    return -1;
+}
+
+int History::findSlot(const ProcStat &p) const{
+    int slot = p.pid > 0 ? findSlot(p.pid) : -1;
+    return slot >= 0 && m_slots[slot].starttime == p.starttime ? slot : -1;
+}
+
+// giving a process among the top ones a slot, taking over the one ranked longest ago
+// (a pid has at most one slot: when it is reused, the new process takes over the old one's)
+void History::track(const ProcStat &p){
+    int slot = findSlot(p.pid);
+    if (slot < 0){
+        slot = 0;
+        for (size_t s = 1; s < m_slots.size(); ++s){
+            if (m_slots[s].ranked < m_slots[slot].ranked){
+                slot = static_cast<int>(s);
+            }
+        }
+    }
+
+    // a slot taken from another process, or the pid was reused: the old history is not this one's
+    ProcSlot &taken = m_slots[slot];
+    if (taken.pid != p.pid || taken.starttime != p.starttime){
+        taken.pid = p.pid;
+        taken.starttime = p.starttime;
+
+        float *cpu = &m_proc_cpu[slot * m_capacity];
+        float *rss = &m_proc_rss_kb[slot * m_capacity];
+        std::fill(cpu, cpu + m_capacity, MISSING);
+        std::fill(rss, rss + m_capacity, MISSING);
+    }
+
+    m_slots[slot].ranked = m_pushes;
+}
+
+// picking the top processes by cpu and by memory, partial ordering only
+void History::rank(const SystemSnapshot &snapshot){
+    const std::vector<ProcStat> &procs = snapshot.procs;
+    size_t top = std::min(m_top, procs.size());
+    if (top == 0){
+        return;
+    }
+
+    m_order.resize(procs.size()); // only allocates past the largest process count so far
+    for (size_t i = 0; i < procs.size(); ++i){
+        m_order[i] = static_cast<int>(i);
+    }
+
+    std::nth_element(m_order.begin(), m_order.begin() + (top - 1), m_order.end(), [&procs](int a, int b){
+        return procs[a].cpu_percent > procs[b].cpu_percent;
+    });
+    for (size_t i = 0; i < top; ++i){
+        track(procs[m_order[i]]);
+    }
+
+    std::nth_element(m_order.begin(), m_order.begin() + (top - 1), m_order.end(), [&procs](int a, int b){
+        return procs[a].memb_kb > procs[b].memb_kb;
+    });
+    for (size_t i = 0; i < top; ++i){
+        track(procs[m_order[i]]);
+    }
+}
+
+void History::push(const SystemSnapshot &snapshot){
+    ++m_pushes;
+    size_t at = m_next;
+
+    // cores beyond the ones there is room for (hotplugged after startup) are not kept
+    for (size_t core = 0; core < m_cores; ++core){
+        m_core_usage[core * m_capacity + at] = core < snapshot.cpu.rows() ? snapshot.cpu.busy[core] : MISSING;
+    }
+
+    const MemStat &mem = snapshot.mem;
+    float total = mem.total_kb > 0 ? static_cast<float>(mem.total_kb) : 1.0f;
+    m_mem[static_cast<size_t>(MemSeries::Used) * m_capacity + at] = mem.used_kb * 100.0f / total;
+    m_mem[static_cast<size_t>(MemSeries::Buffers) * m_capacity + at] = mem.buffers_kb * 100.0f / total;
+    m_mem[static_cast<size_t>(MemSeries::Cached) * m_capacity + at] = mem.cached_kb * 100.0f / total;
+    m_mem[static_cast<size_t>(MemSeries::Free) * m_capacity + at] = mem.free_kb * 100.0f / total;
+
+    rank(snapshot);
+
+    // every tracked process gets a value, or a gap once it has exited
+    // (one pass over the processes, each looked up among the few tracked pids by binary search)
+    m_tracked.clear();
+    for (size_t s = 0; s < m_slots.size(); ++s){
+        m_proc_cpu[s * m_capacity + at] = MISSING;
+        m_proc_rss_kb[s * m_capacity + at] = MISSING;
+        if (m_slots[s].pid > 0){
+            m_tracked.push_back({m_slots[s].pid, static_cast<int>(s)});
+        }
+    }
+    std::sort(m_tracked.begin(), m_tracked.end());
+
+    for (const ProcStat &p : snapshot.procs){
+        auto it = std::lower_bound(m_tracked.begin(), m_tracked.end(), std::make_pair(p.pid, 0));
+        if (it == m_tracked.end() || it->first != p.pid){
+            continue;
+        }
+        int slot = it->second;
+        if (m_slots[slot].starttime == p.starttime){
+            m_proc_cpu[slot * m_capacity + at] = static_cast<float>(p.cpu_percent);
+            m_proc_rss_kb[slot * m_capacity + at] = static_cast<float>(p.memb_kb);
+        }
+    }
+
+    m_next = (m_next + 1) % m_capacity;
+    m_count = std::min(m_count + 1, m_capacity);
+}
+
+size_t History::copyOut(const std::vector<float> &rings, size_t ring, float *out, size_t n) const{
+    n = std::min(n, m_count);
+    const float *base = &rings[ring * m_capacity];
+
+    // the latest n values end right before m_next, wrapping around the ring
+    size_t start = (m_next + m_capacity - n) % m_capacity;
+    size_t first = std::min(n, m_capacity - start);
+    std::copy(base + start, base + start + first, out);
+    std::copy(base, base + (n - first), out + first);
+    return n;
+}
+
+size_t History::coreUsage(size_t core, float *out, size_t n) const{
+    return core < m_cores ? copyOut(m_core_usage, core, out, n) : 0;
+}
+
+size_t History::mem(MemSeries series, float *out, size_t n) const{
+    return copyOut(m_mem, static_cast<size_t>(series), out, n);
+}
+
+size_t History::procCpu(const ProcStat &p, float *out, size_t n) const{
+    int slot = findSlot(p);
+    return slot >= 0 ? copyOut(m_proc_cpu, slot, out, n) : 0;
+}
+
+size_t History::procRssKB(const ProcStat &p, float *out, size_t n) const{
+    int slot = findSlot(p);
+    return slot >= 0 ? copyOut(m_proc_rss_kb, slot, out, n) : 0;
+}
@@ -1,6 +1,176 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../include/options.hpp"
+#include "../include/recorder.hpp"
+#include "../include/replay.hpp"
 #include "../include/ui.hpp"
 
-int main() {
-    draw();
-    return 0;
+// shortest time between samples -d accepts
+static const double MIN_DELAY_SECONDS = 0.1;
+
+static void printUsage(const char *program){
+    std::printf("usage: %s [options]\n", program);
+    std::printf("  -d, --delay SECS  time between samples, down to 0.1 (default: 1)\n");
+    std::printf("  -w, --workers N   threads scanning /proc (default: online cores / 4)\n");
+    std::printf("  -b, --backend B   per-process collector: procfs (default) or taskstats\n");
+    std::printf("  -H, --history N   samples kept for the trend sparklines (default: 120)\n");
+    std::printf("  --cpu-groups G    group cores of the cpu heatmap by node, socket or none (default: auto)\n");
+    std::printf("  --pss             show PSS and USS of the rows on screen next to resident memory\n");
+    std::printf("  --record FILE     headless: append samples to FILE until interrupted\n");
+    std::printf("  --dump FILE       print a recording made with --record\n");
+    std::printf("  --capture FILE    headless: capture raw /proc contents to FILE until interrupted\n");
+    std::printf("  --replay FILE     show a capture made with --capture instead of this system\n");
+    std::printf("  -h, --help        show this help\n");
+}
+
+// parsing argv into options, returns false (after printing why) on bad input
+static bool parseOptions(int argc, char **argv, Options &options){
+    for (int i = 1; i < argc; ++i){
+        const char *arg = argv[i];
+
+        if (std::strcmp(arg, "-h") == 0 || std::strcmp(arg, "--help") == 0){
+            printUsage(argv[0]);
+            std::exit(0);
+        }
+
+        if (std::strcmp(arg, "-d") == 0 || std::strcmp(arg, "--delay") == 0){
+            if (i + 1 >= argc){
+                std::fprintf(stderr, "%s: %s needs a value\n", argv[0], arg);
+                return false;
+            }
+
+            double seconds = std::atof(argv[++i]);
+            if (seconds < MIN_DELAY_SECONDS){
+                std::fprintf(stderr, "%s: delay must be at least %.1f seconds\n", argv[0], MIN_DELAY_SECONDS);
+                return false;
+            }
+            options.sample_interval = std::chrono::milliseconds(static_cast<long long>(seconds * 1000.0 + 0.5));
+            continue;
+        }
+
+        if (std::strcmp(arg, "-w") == 0 || std::strcmp(arg, "--workers") == 0){
+            if (i + 1 >= argc){
+                std::fprintf(stderr, "%s: %s needs a value\n", argv[0], arg);
+                return false;
+            }
+
+            int workers = std::atoi(argv[++i]);
+            if (workers < 1){
+                std::fprintf(stderr, "%s: workers must be at least 1\n", argv[0]);
+                return false;
+            }
+            options.scan_workers = static_cast<size_t>(workers);
+            continue;
+        }
+
+        if (std::strcmp(arg, "-H") == 0 || std::strcmp(arg, "--history") == 0){
+            if (i + 1 >= argc){
+                std::fprintf(stderr, "%s: %s needs a value\n", argv[0], arg);
+                return false;
+            }
+
+            int samples = std::atoi(argv[++i]);
+            if (samples < 1){
+                std::fprintf(stderr, "%s: history must be at least 1 sample\n", argv[0]);
+                return false;
+            }
+            options.history_samples = static_cast<size_t>(samples);
+            continue;
+        }
+
+        if (std::strcmp(arg, "-b") == 0 || std::strcmp(arg, "--backend") == 0){
+            if (i + 1 >= argc){
+                std::fprintf(stderr, "%s: %s needs a value\n", argv[0], arg);
+                return false;
+            }
+
+            const char *backend = argv[++i];
+            if (std::strcmp(backend, "procfs") == 0){
+                options.proc_backend = ProcBackend::Procfs;
+            } else if (std::strcmp(backend, "taskstats") == 0){
+                options.proc_backend = ProcBackend::Taskstats;
+            } else {
+                std::fprintf(stderr, "%s: unknown backend '%s'\n", argv[0], backend);
+                return false;
+            }
+            continue;
+        }
+
+        if (std::strcmp(arg, "--cpu-groups") == 0){
+            if (i + 1 >= argc){
+                std::fprintf(stderr, "%s: %s needs a value\n", argv[0], arg);
+                return false;
+            }
+
+            const char *grouping = argv[++i];
+            bool known = false;
+            for (CpuGrouping g : {CpuGrouping::Auto, CpuGrouping::Node, CpuGrouping::Socket, CpuGrouping::None}){
+                if (std::strcmp(grouping, cpuGroupingName(g)) == 0){
+                    options.cpu_grouping = g;
+                    known = true;
+                }
+            }
+            if (!known){
+                std::fprintf(stderr, "%s: unknown cpu grouping '%s'\n", argv[0], grouping);
+                return false;
+            }
+            continue;
+        }
+
+        if (std::strcmp(arg, "--pss") == 0){
+            options.pss = true;
+            continue;
+        }
+
+        if (std::strcmp(arg, "--record") == 0 || std::strcmp(arg, "--dump") == 0){
+            if (i + 1 >= argc){
+                std::fprintf(stderr, "%s: %s needs a value\n", argv[0], arg);
+                return false;
+            }
+
+            std::string &path = arg[2] == 'r' ? options.record_path : options.dump_path;
+            path = argv[++i];
+            continue;
+        }
+
+        if (std::strcmp(arg, "--capture") == 0 || std::strcmp(arg, "--replay") == 0){
+            if (i + 1 >= argc){
+                std::fprintf(stderr, "%s: %s needs a value\n", argv[0], arg);
+                return false;
+            }
+
+            std::string &path = arg[2] == 'c' ? options.capture_path : options.replay_path;
+            path = argv[++i];
+            continue;
+        }
+
+        std::fprintf(stderr, "%s: unknown option '%s'\n", argv[0], arg);
+        printUsage(argv[0]);
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)){
+        return 1;
+    }
+
+    if (!options.dump_path.empty()){
+        return dumpRecording(options.dump_path);
+    }
+
+    if (!options.record_path.empty()){
+        return runRecorder(options.record_path, options.sample_interval, options);
+    }
+
+    if (!options.capture_path.empty()){
+        return runCapture(options.capture_path, options.sample_interval);
+    }
+
+    return draw(options);
 }
@@ -0,0 +1,141 @@
+#include <charconv>
+#include <cstring>
+
+#include "../include/net.hpp"
+
+bool parseNetDevLine(const char *p, const char *end, const char *&name, size_t &name_len, NetCounters &counters){
+    // the name is right-aligned in front of a ':', the header lines have none
+    while (p < end && *p == ' ') ++p;
+    const char *colon = static_cast<const char*>(std::memchr(p, ':', end - p));
+    if (!colon || colon == p){
+        return false;
+    }
+    name = p;
+    name_len = colon - p;
+
+    // receive: bytes packets errs drop fifo frame compressed multicast,
+    // transmit: bytes packets errs drop fifo colls carrier compressed
+    unsigned long long *const wanted[16] = {
+        &counters.rx_bytes, &counters.rx_packets, &counters.rx_errors, &counters.rx_drops, nullptr, nullptr, nullptr, nullptr,
+        &counters.tx_bytes, &counters.tx_packets, &counters.tx_errors, &counters.tx_drops, nullptr, nullptr, nullptr, nullptr,
+    };
+
+    p = colon + 1;
+    for (unsigned long long *field : wanted){
+        while (p < end && *p == ' ') ++p;
+        unsigned long long skipped;
+        std::from_chars_result result = std::from_chars(p, end, field ? *field : skipped);
+        if (result.ec != std::errc()){
+            return false;
+        }
+        p = result.ptr;
+    }
+    return true;
+}
+
+size_t NetTable::slotOf(const char *name, size_t len, size_t row){
+    if (row < m_rows.size()){
+        const std::string &previous = m_slots[m_rows[row]].name;
+        if (previous.size() == len && std::memcmp(previous.data(), name, len) == 0){
+            return m_rows[row];
+        }
+    }
+
+    m_name.assign(name, len);
+    auto it = m_ids.find(m_name);
+    if (it != m_ids.end()){
+        return it->second;
+    }
+
+    size_t slot;
+    if (!m_free.empty()){
+        slot = m_free.back();
+        m_free.pop_back();
+    } else {
+        slot = m_slots.size();
+        m_slots.emplace_back();
+    }
+    m_slots[slot].name = m_name;
+    m_slots[slot].tick = 0; // never seen, so no rate yet
+    m_ids.emplace(m_name, slot);
+    return slot;
+}
+
+// counts per second between two readings, 0 if the counter went backwards (the interface was reset)
+static double perSecond(unsigned long long prev, unsigned long long curr, double seconds){
+    return curr >= prev ? (curr - prev) / seconds : 0.0;
+}
+
+bool NetTable::sample(ProcSource &source, uint64_t now_ns, std::vector<NetStat> &out){
+    if (!source.read("net/dev", m_contents)){
+        out.clear();
+        return false;
+    }
+
+    ++m_tick;
+    double seconds = m_prev_ns > 0 && now_ns > m_prev_ns ? (now_ns - m_prev_ns) / 1e9 : 0.0;
+
+    // one pass over the file, every row reusing the string and counters of the same row last time
+    size_t rows = 0;
+    const char *p = m_contents.data();
+    const char *end = p + m_contents.size();
+    NetCounters counters;
+    const char *name;
+    size_t name_len;
+    while (p < end){
+        const char *newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char *line_end = newline ? newline : end;
+
+        if (parseNetDevLine(p, line_end, name, name_len, counters)){
+            size_t slot_index = slotOf(name, name_len, rows);
+            Slot &slot = m_slots[slot_index];
+
+            if (rows == out.size()){
+                out.emplace_back();
+            }
+            NetStat &stat = out[rows];
+            stat.name = slot.name; // keeps the row's string capacity
+            stat.counters = counters;
+
+            stat.has_rate = slot.tick != 0 && slot.tick + 1 == m_tick && seconds > 0.0;
+            if (stat.has_rate){
+                const NetCounters &prev = slot.counters;
+                stat.rx_rate = perSecond(prev.rx_bytes, counters.rx_bytes, seconds);
+                stat.tx_rate = perSecond(prev.tx_bytes, counters.tx_bytes, seconds);
+                stat.rx_packet_rate = perSecond(prev.rx_packets, counters.rx_packets, seconds);
+                stat.tx_packet_rate = perSecond(prev.tx_packets, counters.tx_packets, seconds);
+                stat.drop_rate = perSecond(prev.rx_drops + prev.tx_drops, counters.rx_drops + counters.tx_drops, seconds);
+                stat.error_rate = perSecond(prev.rx_errors + prev.tx_errors, counters.rx_errors + counters.tx_errors, seconds);
+            } else {
+                stat.rx_rate = stat.tx_rate = stat.rx_packet_rate = stat.tx_packet_rate = 0.0;
+                stat.drop_rate = stat.error_rate = 0.0;
+            }
+
+            slot.counters = counters;
+            slot.tick = m_tick;
+
+            if (rows == m_rows.size()){
+                m_rows.push_back(slot_index);
+            } else {
+                m_rows[rows] = slot_index;
+            }
+            ++rows;
+        }
+
+        p = line_end + 1;
+    }
+    out.resize(rows);
+    m_rows.resize(rows);
+    m_prev_ns = now_ns;
+
+    // forgetting interfaces that went away (containers stopping take their veths with them)
+    for (size_t i = 0; i < m_slots.size(); ++i){
+        Slot &slot = m_slots[i];
+        if (!slot.name.empty() && slot.tick != m_tick){
+            m_ids.erase(slot.name);
+            slot.name.clear();
+            m_free.push_back(i);
+        }
+    }
+    return true;
+}
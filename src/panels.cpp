@@ -0,0 +1,1789 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "../include/panels.hpp"
+
+// pages before and after the current one whose command lines are read ahead
+static const int CMDLINE_PREFETCH_PAGES = 1;
+
+// width of the proc panel's trend column
+static const int PROC_TREND_WIDTH = 10;
+
+// width of each of the proc panel's i/o rate columns
+static const int PROC_RATE_WIDTH = 7;
+
+// lowest and highest value of a series, gaps (NaN) skipped, false if there are only gaps
+static bool seriesRange(const float *values, size_t n, float &lo, float &hi){
+    bool found = false;
+    for (size_t i = 0; i < n; ++i){
+        if (values[i] != values[i]){
+            continue;
+        }
+        lo = found ? std::min(lo, values[i]) : values[i];
+        hi = found ? std::max(hi, values[i]) : values[i];
+        found = true;
+    }
+    return found;
+}
+
+// a sparkline of the latest width values of a series into out (width characters, not terminated),
+// one character per value from '_' at lo to '@' at hi, right-aligned, gaps (NaN) left blank
+static void formatSparkline(char *out, const float *values, size_t n, int width, float lo, float hi){
+    static const char LEVELS[] = "_.:-=+*#@";
+    const int top = sizeof(LEVELS) - 2;
+
+    int pad = std::max(0, width - static_cast<int>(n));
+    std::memset(out, ' ', pad);
+
+    const float *v = values + (n > static_cast<size_t>(width) ? n - width : 0);
+    for (int i = pad; i < width; ++i, ++v){
+        if (*v != *v){
+            out[i] = ' ';
+            continue;
+        }
+        int level = hi > lo ? static_cast<int>((*v - lo) / (hi - lo) * top + 0.5f) : (*v > 0 ? top / 2 : 0);
+        out[i] = LEVELS[std::min(std::max(level, 0), top)];
+    }
+}
+
+// a per-second count in at most 6 characters: 512, 12.3K, 4.5M, 1.2G
+static void formatRate(char *out, size_t size, double per_second){
+    static const char UNITS[] = "KMGT";
+    if (per_second < 999.5){
+        snprintf(out, size, "%.0f", per_second);
+        return;
+    }
+
+    int unit = -1;
+    while (per_second >= 999.5 && unit + 1 < static_cast<int>(sizeof(UNITS)) - 1){
+        per_second /= 1024.0;
+        ++unit;
+    }
+    snprintf(out, size, per_second < 99.95 ? "%.1f%c" : "%.0f%c", per_second, UNITS[unit]);
+}
+
+// ─────────────────────────────────────────────
+// Panel
+// ─────────────────────────────────────────────
+
+bool Panel::rowChanged(int y, const char *content, size_t len){
+    if (y < 0){
+        return false;
+    }
+    if (static_cast<size_t>(y) >= m_rows.size()){
+        m_rows.resize(y + 1);
+    }
+
+    std::string &row = m_rows[y];
+    if (row.size() == len && std::memcmp(row.data(), content, len) == 0){
+        return false;
+    }
+    row.assign(content, len); // keeps the capacity once rows have been drawn
+    return true;
+}
+
+void Panel::drawTextRow(int y, int x, const char *text, size_t len){
+    if (!rowChanged(y, text, len)){
+        return;
+    }
+    mvwhline(win, y, 1, ' ', getmaxx(win) - 2);
+    mvwaddnstr(win, y, x, text, static_cast<int>(len));
+}
+
+void Panel::clearBottomBorder(){
+    mvwhline(win, getmaxy(win) - 1, 1, ACS_HLINE, getmaxx(win) - 2);
+}
+
+Panel::Panel
+(
+    const std::string& title,
+    int title_color_pair,
+    int height,
+    int width,
+    int pos_y,
+    int pos_x
+)
+:
+    win(newwin(height, width, pos_y, pos_x)),
+    m_title(title),
+    m_title_color_pair(title_color_pair),
+    m_height(height),
+    m_width(width),
+    m_pos_y(pos_y),
+    m_pos_x(pos_x)
+{}
+
+Panel::~Panel() {
+    if (win){
+        delwin(win);
+    }
+}
+
+void Panel::drawPanel(){
+    if (m_chrome_drawn){
+        return;
+    }
+    m_chrome_drawn = true;
+
+    box(win,0,0); // drawing outer border
+
+    // title of the panel
+    wattron(win, COLOR_PAIR(m_title_color_pair) | A_BOLD);
+    mvwprintw(win, 0, 1, " %s ", m_title.c_str());
+    wattroff(win, COLOR_PAIR(m_title_color_pair) | A_BOLD);
+
+    wnoutrefresh(win); // marking window for update
+}
+
+void Panel::touch(){
+    touchwin(win);
+}
+
+void Panel::rebuild(int height, int width, int pos_y, int pos_x) {
+    if (win) {
+        delwin(win);
+    }
+    m_height = height;
+    m_width  = width;
+    m_pos_y  = pos_y;
+    m_pos_x  = pos_x;
+    win = newwin(height, width, pos_y, pos_x);
+
+    // a new window starts blank, everything is drawn again
+    m_chrome_drawn = false;
+    m_rows.clear();
+}
+
+// ─────────────────────────────────────────────
+// SystemInfoPanel
+// ─────────────────────────────────────────────
+
+void SystemInfoPanel::drawVisuals(const SystemSnapshot &snapshot){
+    char text[256];
+    int len;
+
+    // os name
+    len = snprintf(text, sizeof(text), " %s ", snapshot.os_name.c_str());
+    drawTextRow(2, 1, text, std::min<size_t>(len, sizeof(text) - 1));
+
+    // time
+    std::string system_time = getOSTime(snapshot.time);
+    len = snprintf(text, sizeof(text), " %s ", system_time.c_str());
+    drawTextRow(4, 1, text, std::min<size_t>(len, sizeof(text) - 1));
+
+    // number of processes
+    len = snprintf(text, sizeof(text), " Total number of processes: %zu (%s) ", snapshot.num_procs, procBackendName(snapshot.backend));
+    drawTextRow(6, 1, text, std::min<size_t>(len, sizeof(text) - 1));
+}
+
+SystemInfoPanel::SystemInfoPanel(
+    int height, // height of the panel
+    int width, // width of the panel
+    int y, // y coordinate of the panel
+    int x // x coordinate of the panel
+)
+:
+Panel(
+    "sys_info", // title
+    2, // color pair
+    height,
+    width,
+    y,
+    x) {}
+
+void SystemInfoPanel::drawSysInfo(const SystemSnapshot &snapshot){
+    // drawing the system info panel first
+    drawPanel();
+
+    // drawing visuals
+    drawVisuals(snapshot);
+
+    wnoutrefresh(win); // refreshing window (system info panel contents)
+}
+
+// ─────────────────────────────────────────────
+// ProcPanel
+// ─────────────────────────────────────────────
+
+static const char *procSortKeyName(ProcSortKey key){
+    switch (key){
+        case ProcSortKey::Pid: return "pid";
+        case ProcSortKey::Name: return "name";
+        case ProcSortKey::Threads: return "thr";
+        case ProcSortKey::Vsize: return "vsz";
+        case ProcSortKey::Cpu: return "cpu";
+        case ProcSortKey::ReadRate: return "read";
+        case ProcSortKey::WriteRate: return "write";
+        case ProcSortKey::Syscalls: return "sysc";
+        default: return "mem";
+    }
+}
+
+void ProcPanel::orderWindow(int &begin, int &end) const{
+    int max_rows = m_height - 4;
+    int num_procs = static_cast<int>(m_order.size());
+    begin = std::min(std::max(0, (m_page - CMDLINE_PREFETCH_PAGES) * max_rows), num_procs);
+    end = std::min((m_page + 1 + CMDLINE_PREFETCH_PAGES) * max_rows, num_procs);
+}
+
+template <typename Less>
+void ProcPanel::orderRange(int begin, int end, Less less){
+    const std::vector<ProcStat> &procs = m_snapshot->procs;
+
+    // ties broken by pid so rows do not swap places between refreshes
+    auto cmp = [&procs, &less](int a, int b){
+        if (less(procs[a], procs[b])) return true;
+        if (less(procs[b], procs[a])) return false;
+        return procs[a].pid < procs[b].pid;
+    };
+
+    auto first = m_order.begin();
+    if (begin > 0){
+        std::nth_element(first, first + begin, m_order.end(), cmp);
+    }
+    if (end < static_cast<int>(m_order.size())){
+        std::nth_element(first + begin, first + end, m_order.end(), cmp);
+    }
+    std::sort(first + begin, first + end, cmp);
+}
+
+double ProcPanel::ioRate(const ProcStat &p, double rate){
+    return p.io_valid ? rate : -1.0;
+}
+
+void ProcPanel::orderProcs(){
+    int begin, end;
+    orderWindow(begin, end);
+    if (m_sorted_begin <= begin && end <= m_sorted_end){
+        return;
+    }
+
+    switch (m_sort_key){
+        case ProcSortKey::Pid:
+            orderRange(begin, end, [](const ProcStat &a, const ProcStat &b){ return a.pid < b.pid; });
+            break;
+        case ProcSortKey::Name:
+            orderRange(begin, end, [](const ProcStat &a, const ProcStat &b){ return a.process_name < b.process_name; });
+            break;
+        case ProcSortKey::Threads:
+            orderRange(begin, end, [](const ProcStat &a, const ProcStat &b){ return a.threads > b.threads; });
+            break;
+        case ProcSortKey::Vsize:
+            orderRange(begin, end, [](const ProcStat &a, const ProcStat &b){ return a.vsize > b.vsize; });
+            break;
+        case ProcSortKey::Cpu:
+            orderRange(begin, end, [](const ProcStat &a, const ProcStat &b){ return a.cpu_percent > b.cpu_percent; });
+            break;
+        case ProcSortKey::ReadRate:
+            orderRange(begin, end, [](const ProcStat &a, const ProcStat &b){ return ioRate(a, a.read_rate) > ioRate(b, b.read_rate); });
+            break;
+        case ProcSortKey::WriteRate:
+            orderRange(begin, end, [](const ProcStat &a, const ProcStat &b){ return ioRate(a, a.write_rate) > ioRate(b, b.write_rate); });
+            break;
+        case ProcSortKey::Syscalls:
+            orderRange(begin, end, [](const ProcStat &a, const ProcStat &b){ return ioRate(a, a.syscall_rate) > ioRate(b, b.syscall_rate); });
+            break;
+        default:
+            // rows whose PSS was read rank by it, their neighbours by resident memory until they
+            // come on screen and get theirs read too, so a page settles within a few samples
+            orderRange(begin, end, [](const ProcStat &a, const ProcStat &b){ return a.memb_kb > b.memb_kb; });
+            break;
+    }
+
+    m_sorted_begin = begin;
+    m_sorted_end = end;
+}
+
+void ProcPanel::resetOrder(){
+    if (m_filter.empty()){
+        m_order.resize(m_snapshot->procs.size());
+        for (size_t i = 0; i < m_order.size(); ++i){
+            m_order[i] = static_cast<int>(i);
+        }
+    } else {
+        m_index.match(m_snapshot->procs, m_filter, m_order);
+    }
+    m_sorted_begin = m_sorted_end = 0;
+}
+
+void ProcPanel::applyFilter(){
+    parseProcFilter(m_filter_text, m_filter, m_filter_error);
+    m_page = 0;
+    if (m_snapshot){
+        resetOrder();
+        orderProcs();
+    }
+}
+
+int ProcPanel::footer(char *line, size_t size, int total_pages) const{
+    if (m_editing){
+        if (!m_filter_error.empty()){
+            return snprintf(line, size, "/%s_ | bad term: %s | enter/esc", m_filter_text.c_str(), m_filter_error.c_str());
+        }
+        return snprintf(line, size, "/%s_ | %zu match | enter/esc", m_filter_text.c_str(), m_order.size());
+    }
+    if (!m_filter_text.empty()){
+        return snprintf(line, size, "page %d/%d | filter: %s (%zu) | sort: %s (p/n/t/m/v/c/r/w/s)", m_page+1, total_pages, m_filter_text.c_str(), m_order.size(), procSortKeyName(m_sort_key));
+    }
+    return snprintf(line, size, "page %d/%d | / search | sort: %s (p/n/t/m/v/c/r/w/s)", m_page+1, total_pages, procSortKeyName(m_sort_key));
+}
+
+void ProcPanel::drawVisuals(){
+    const std::vector<ProcStat> &procs = m_snapshot->procs;
+    int win_width = getmaxx(win);
+
+    // a row is its color followed by its text, so a color change alone also redraws it
+    char line[1024];
+    int len;
+
+    // column header and divider, unchanged until the layout changes
+    len = snprintf(line, sizeof(line), "%-6s %-20s %-6s %6s %-10s %-*s%*s %*s %*s %-*s %s", "PID", "NAME", "THR", "CPU%", "MEM(KB)",
+                   m_pss ? 22 : 0, m_pss ? "PSS(KB)    USS(KB)" : "", PROC_RATE_WIDTH, "READ/s", PROC_RATE_WIDTH, "WRITE/s", PROC_RATE_WIDTH, "SYSC/s", PROC_TREND_WIDTH, "TREND", "COMMAND");
+    if (rowChanged(1, line, len)){
+        wattron(win, A_BOLD | COLOR_PAIR(7));
+        mvwprintw(win, 1, 2, "%s", line);
+        wattroff(win, A_BOLD | COLOR_PAIR(7));
+
+        mvwhline(win, 2, 2, '-', win_width - 4);
+    }
+
+
+    int max_rows = m_height - 4;
+    int start = m_page * max_rows;
+    int end = std::min(start + max_rows, static_cast<int>(m_order.size()));
+
+    // truncating command to fit in remaining width
+    // 2 margin + 6pid + 1 + 20 name + 1 + 6 thr + 1 + 6 cpu + 1 + 10 mem + 1 + (2 * (10 pss/uss + 1)) + 3 * (rate + 1) + trend + 1 + 2 margin
+    int cmd_max = std::max(win_width - 57 - (m_pss ? 22 : 0) - 3 * (PROC_RATE_WIDTH + 1) - PROC_TREND_WIDTH - 1, 0);
+
+    // memory sorts show how resident memory moved, the others cpu
+    bool rss_trend = m_sort_key == ProcSortKey::Memory || m_sort_key == ProcSortKey::Vsize;
+    char trend[PROC_TREND_WIDTH + 1];
+    trend[PROC_TREND_WIDTH] = '\0';
+
+    for (int row = 3; row < 3 + max_rows; ++row){
+        int i = start + row - 3;
+
+        // rows past the last process are blanked once
+        if (i >= end){
+            if (rowChanged(row, "", 0)){
+                mvwhline(win, row, 2, ' ', win_width - 4);
+            }
+            continue;
+        }
+
+        const ProcStat &p = procs[m_order[i]];
+        const std::string &cmd = p.command_name.empty() ? p.process_name : p.command_name;
+
+
+        // adding color based on memory usage
+        int color = 0;
+        if (p.memb_kb>500000){
+            color = 3; // red - 500MB
+        } else if (p.memb_kb > 100000) {
+            color = 2; // yellow - 100MB
+        }
+        // else {
+        //     color = 1;
+        // }
+
+        // proportional and unique memory next to resident, "-" where smaps_rollup was not read
+        char pss[32] = "";
+        if (m_pss){
+            if (p.pss_valid){
+                snprintf(pss, sizeof(pss), "%-10lu %-10lu ", p.pss_kb, p.uss_kb);
+            } else {
+                snprintf(pss, sizeof(pss), "%-10s %-10s ", "-", "-");
+            }
+        }
+
+        // i/o is only read for some rows (see ProcTable::readIo), "-" for the others
+        char read_rate[16] = "-", write_rate[16] = "-", syscall_rate[16] = "-";
+        if (p.io_valid){
+            formatRate(read_rate, sizeof(read_rate), p.read_rate);
+            formatRate(write_rate, sizeof(write_rate), p.write_rate);
+            formatRate(syscall_rate, sizeof(syscall_rate), p.syscall_rate);
+        }
+
+        // tracked processes only, blank for the rest
+        std::memset(trend, ' ', PROC_TREND_WIDTH);
+        if (m_history){
+            size_t n = rss_trend ? m_history->procRssKB(p, m_trend.data(), PROC_TREND_WIDTH)
+                                 : m_history->procCpu(p, m_trend.data(), PROC_TREND_WIDTH);
+            float lo, hi;
+            if (seriesRange(m_trend.data(), n, lo, hi)){
+                // cpu from zero up to its peak, memory between its own low and high
+                if (!rss_trend){
+                    lo = 0.0f;
+                    hi = std::max(hi, 1.0f);
+                }
+                formatSparkline(trend, m_trend.data(), n, PROC_TREND_WIDTH, lo, hi);
+            }
+        }
+
+        line[0] = static_cast<char>('0' + color);
+        len = snprintf(line + 1, sizeof(line) - 1, "%-6d %-20.20s %-6d %6.1f %-10lu %s%*s %*s %*s %s %.*s", p.pid, p.process_name.c_str(), p.threads, p.cpu_percent, p.memb_kb, pss,
+                       PROC_RATE_WIDTH, read_rate, PROC_RATE_WIDTH, write_rate, PROC_RATE_WIDTH, syscall_rate, trend, cmd_max, cmd.c_str());
+        len = std::min<int>(len, sizeof(line) - 2) + 1;
+
+        if (!rowChanged(row, line, len)){
+            continue;
+        }
+
+        // drawing the row
+        mvwhline(win, row, 2, ' ', win_width - 4); // clearing row
+        wattron(win, COLOR_PAIR(color));
+        mvwaddnstr(win, row, 2, line + 1, len - 1);
+        wattroff(win, COLOR_PAIR(color));
+    }
+
+    // page indicator (or search prompt) at the bottom
+    int total_pages = (static_cast<int>(m_order.size()) + max_rows - 1)/max_rows;
+    len = std::min<int>(footer(line, sizeof(line), total_pages), sizeof(line) - 1);
+    len = std::min(len, std::max(win_width - 4, 0));
+    if (rowChanged(m_height - 1, line, len)){
+        clearBottomBorder();
+        mvwaddnstr(win, m_height-1, 2, line, len);
+    }
+}
+
+ProcPanel::ProcPanel(
+    int height, // height of the panel
+    int width, // width of the panel
+    int y, // y coordinate of the panel
+    int x // x coordinate of the panel
+)
+:
+Panel(
+    "proc", // title
+    1, // color pair
+    height,
+    width,
+    y,
+    x) {}
+
+void ProcPanel::drawProcStats(std::shared_ptr<const SystemSnapshot> snapshot, const History &history){
+    m_history = &history;
+    m_trend.resize(PROC_TREND_WIDTH);
+
+    {
+        StageTimer timer(Stage::Sort);
+        if (snapshot != m_snapshot){
+            m_snapshot = std::move(snapshot);
+            m_index.update(m_snapshot->procs);
+            resetOrder();
+            changePage(0); // matches may have gone away
+        }
+        orderProcs(); // the page or the layout may have changed too
+    }
+
+    // drawing the proc panel first
+    drawPanel();
+
+    // drawing visuals
+    drawVisuals();
+
+    wnoutrefresh(win); // refreshing window (proc panel contents)
+
+}
+
+void ProcPanel::setPss(bool pss){
+    m_pss = pss;
+}
+
+void ProcPanel::setSortKey(ProcSortKey key){
+    if (key == m_sort_key){
+        return;
+    }
+    m_sort_key = key;
+    m_page = 0;
+    if (m_snapshot){
+        resetOrder();
+        orderProcs();
+    }
+}
+
+void ProcPanel::startFilter(){
+    m_editing = true;
+    m_filter_before = m_filter_text;
+}
+
+void ProcPanel::editFilter(int ch){
+    if (ch == '\n' || ch == KEY_ENTER){
+        m_editing = false;
+        return;
+    }
+    if (ch == 27){
+        m_editing = false;
+        m_filter_text = m_filter_before;
+    } else if (ch == KEY_BACKSPACE || ch == 127 || ch == 8){
+        if (m_filter_text.empty()){
+            return;
+        }
+        m_filter_text.pop_back();
+    } else if (ch == 21){ // ctrl-u
+        m_filter_text.clear();
+    } else if (ch >= 0x20 && ch < 0x7f){
+        m_filter_text.push_back(static_cast<char>(ch));
+    } else {
+        return;
+    }
+    applyFilter();
+}
+
+void ProcPanel::cmdlineWindow(std::vector<int> &pids) const{
+    pids.clear();
+    if (!m_snapshot){
+        return;
+    }
+
+    if (m_filter.needsCmdlines()){
+        for (const ProcStat &p : m_snapshot->procs){
+            if (!p.cmdline_loaded){
+                pids.push_back(p.pid);
+            }
+        }
+        return;
+    }
+
+    // the same rows orderProcs() put in place
+    int start, end;
+    orderWindow(start, end);
+
+    for (int i = start; i < end; ++i){
+        pids.push_back(m_snapshot->procs[m_order[i]].pid);
+    }
+}
+
+void ProcPanel::shownWindow(std::vector<int> &pids) const{
+    pids.clear();
+    if (!m_snapshot){
+        return;
+    }
+
+    int max_rows = m_height - 4;
+    int start = std::min(m_page * max_rows, static_cast<int>(m_order.size()));
+    int end = std::min(start + max_rows, static_cast<int>(m_order.size()));
+    for (int i = start; i < end; ++i){
+        pids.push_back(m_snapshot->procs[m_order[i]].pid);
+    }
+}
+
+void ProcPanel::changePage(int direction){
+    m_page += direction;
+
+    // restricting to valid range
+    int max_rows = m_height - 4;
+    int num_procs = static_cast<int>(m_order.size());
+    int total_pages = (num_procs + max_rows - 1)/max_rows;
+
+    if (m_page < 0){
+        m_page = 0;
+    }
+
+    if (m_page >= total_pages){
+        m_page = std::max(0, total_pages - 1);
+    }
+}
+
+// ─────────────────────────────────────────────
+// CgroupPanel
+// ─────────────────────────────────────────────
+
+double CgroupPanel::cpuOf(const CgroupStat &c){
+    return c.cpu_accounted ? c.usage_percent : c.cpu_percent;
+}
+
+unsigned long long CgroupPanel::memoryOf(const CgroupStat &c){
+    return c.memory_accounted ? c.current_kb : c.memb_kb;
+}
+
+void CgroupPanel::orderCgroups(){
+    const std::vector<CgroupStat> &cgroups = m_snapshot->cgroups;
+    m_order.resize(cgroups.size());
+    for (size_t i = 0; i < m_order.size(); ++i){
+        m_order[i] = static_cast<int>(i);
+    }
+
+    // ties broken by path so rows do not swap places between refreshes
+    auto order = [&](auto less){
+        std::sort(m_order.begin(), m_order.end(), [&](int a, int b){
+            if (less(cgroups[a], cgroups[b])) return true;
+            if (less(cgroups[b], cgroups[a])) return false;
+            return cgroups[a].path < cgroups[b].path;
+        });
+    };
+
+    switch (m_sort_key){
+        case ProcSortKey::Pid:
+        case ProcSortKey::Name:
+            order([](const CgroupStat &, const CgroupStat &){ return false; });
+            break;
+        case ProcSortKey::Threads:
+            order([](const CgroupStat &a, const CgroupStat &b){ return a.threads > b.threads; });
+            break;
+        case ProcSortKey::Memory:
+        case ProcSortKey::Vsize:
+            order([](const CgroupStat &a, const CgroupStat &b){ return memoryOf(a) > memoryOf(b); });
+            break;
+        default:
+            order([](const CgroupStat &a, const CgroupStat &b){ return cpuOf(a) > cpuOf(b); });
+            break;
+    }
+}
+
+void CgroupPanel::drawVisuals(){
+    const std::vector<CgroupStat> &cgroups = m_snapshot->cgroups;
+    int win_width = getmaxx(win);
+
+    char line[1024];
+    int len;
+
+    // column header and divider, the process sums first, then the cgroup's own accounting
+    len = snprintf(line, sizeof(line), "%-6s %-6s %6s %-10s %7s %-10s %-10s %-10s %s", "PROCS", "THR", "CPU%", "RSS(KB)", "CG CPU%", "CG MEM(KB)", "ANON(KB)", "FILE(KB)", "CGROUP");
+    if (rowChanged(1, line, len)){
+        wattron(win, A_BOLD | COLOR_PAIR(7));
+        mvwprintw(win, 1, 2, "%s", line);
+        wattroff(win, A_BOLD | COLOR_PAIR(7));
+
+        mvwhline(win, 2, 2, '-', win_width - 4);
+    }
+
+    int max_rows = m_height - 4;
+    int start = m_page * max_rows;
+    int end = std::min(start + max_rows, static_cast<int>(m_order.size()));
+
+    // 2 margin + 6 procs + 1 + 6 thr + 1 + 6 cpu + 1 + 10 rss + 1 + 7 cg cpu + 1 + 3 * (10 + 1) + 2 margin
+    int path_max = std::max(win_width - 78, 0);
+
+    for (int row = 3; row < 3 + max_rows; ++row){
+        int i = start + row - 3;
+
+        // nothing grouped yet: the first sample after turning grouping on has not come in,
+        // or there is no cgroup v2 hierarchy to group by
+        if (cgroups.empty() && row == 3){
+            len = snprintf(line, sizeof(line), "no cgroups yet (waiting for the next sample, or no cgroup v2 hierarchy)");
+            if (rowChanged(row, line, len)){
+                mvwhline(win, row, 2, ' ', win_width - 4);
+                mvwaddnstr(win, row, 2, line, std::min(len, std::max(win_width - 4, 0)));
+            }
+            continue;
+        }
+
+        if (i >= end){
+            if (rowChanged(row, "", 0)){
+                mvwhline(win, row, 2, ' ', win_width - 4);
+            }
+            continue;
+        }
+
+        const CgroupStat &c = cgroups[m_order[i]];
+
+        // the same thresholds as processes, on what the cgroup is charged for
+        unsigned long long memory = memoryOf(c);
+        int color = memory > 500000 ? 3 : memory > 100000 ? 2 : 0;
+
+        // "-" where the cgroup's files could not be read
+        char usage[16] = "-", current[24] = "-", anon[24] = "-", file[24] = "-";
+        if (c.cpu_accounted){
+            snprintf(usage, sizeof(usage), "%.1f", c.usage_percent);
+        }
+        if (c.memory_accounted){
+            snprintf(current, sizeof(current), "%llu", c.current_kb);
+            snprintf(anon, sizeof(anon), "%llu", c.anon_kb);
+            snprintf(file, sizeof(file), "%llu", c.file_kb);
+        }
+
+        line[0] = static_cast<char>('0' + color);
+        len = snprintf(line + 1, sizeof(line) - 1, "%-6zu %-6d %6.1f %-10lu %7s %-10s %-10s %-10s %.*s", c.procs, c.threads, c.cpu_percent, c.memb_kb,
+                       usage, current, anon, file, path_max, c.path.c_str());
+        len = std::min<int>(len, sizeof(line) - 2) + 1;
+
+        if (!rowChanged(row, line, len)){
+            continue;
+        }
+
+        mvwhline(win, row, 2, ' ', win_width - 4);
+        wattron(win, COLOR_PAIR(color));
+        mvwaddnstr(win, row, 2, line + 1, len - 1);
+        wattroff(win, COLOR_PAIR(color));
+    }
+
+    int total_pages = std::max(1, (static_cast<int>(m_order.size()) + max_rows - 1)/max_rows);
+    len = snprintf(line, sizeof(line), "page %d/%d | %zu cgroups | sort: %s | g processes", m_page+1, total_pages, m_order.size(), procSortKeyName(m_sort_key));
+    len = std::min<int>(len, sizeof(line) - 1);
+    len = std::min(len, std::max(win_width - 4, 0));
+    if (rowChanged(m_height - 1, line, len)){
+        clearBottomBorder();
+        mvwaddnstr(win, m_height-1, 2, line, len);
+    }
+}
+
+CgroupPanel::CgroupPanel(
+    int height, // height of the panel
+    int width, // width of the panel
+    int y, // y coordinate of the panel
+    int x // x coordinate of the panel
+)
+:
+Panel(
+    "cgroups", // title
+    1, // color pair
+    height,
+    width,
+    y,
+    x) {}
+
+void CgroupPanel::drawCgroups(std::shared_ptr<const SystemSnapshot> snapshot, ProcSortKey sort_key){
+    if (snapshot != m_snapshot || sort_key != m_sort_key){
+        m_snapshot = std::move(snapshot);
+        m_sort_key = sort_key;
+        orderCgroups();
+        changePage(0); // groups may have gone away
+    }
+
+    drawPanel();
+    drawVisuals();
+    wnoutrefresh(win);
+}
+
+void CgroupPanel::changePage(int direction){
+    int max_rows = m_height - 4;
+    int total_pages = (static_cast<int>(m_order.size()) + max_rows - 1)/max_rows;
+    m_page = std::max(0, std::min(m_page + direction, total_pages - 1));
+}
+
+// ─────────────────────────────────────────────
+// NetPanel
+// ─────────────────────────────────────────────
+
+// width of each of the net panel's rate and total columns
+static const int NET_COLUMN_WIDTH = 8;
+
+static const char *netSortKeyName(NetSortKey key){
+    switch (key){
+        case NetSortKey::Throughput: return "rx+tx";
+        case NetSortKey::Rx: return "rx";
+        case NetSortKey::Tx: return "tx";
+        case NetSortKey::Name: return "name";
+        default: return "?";
+    }
+}
+
+double NetPanel::throughput(const NetStat &n){
+    return n.rx_rate + n.tx_rate;
+}
+
+bool NetPanel::idle(const NetStat &n){
+    return n.has_rate && throughput(n) == 0.0 && n.drop_rate == 0.0 && n.error_rate == 0.0;
+}
+
+int NetPanel::maxRows() const{
+    return std::max(1, m_height - 4);
+}
+
+bool NetPanel::passesFilter(const NetStat &n) const{
+    if (m_hide_idle && idle(n)){
+        return false;
+    }
+    if (m_filter_text.empty() || m_filter_text == "!"){
+        return true;
+    }
+    bool exclude = m_filter_text[0] == '!';
+    bool found = n.name.find(m_filter_text.c_str() + (exclude ? 1 : 0)) != std::string::npos;
+    return found != exclude;
+}
+
+void NetPanel::orderInterfaces(){
+    const std::vector<NetStat> &net = m_snapshot->net;
+    m_order.clear();
+    for (size_t i = 0; i < net.size(); ++i){
+        if (passesFilter(net[i])){
+            m_order.push_back(static_cast<int>(i));
+        }
+    }
+
+    int total_pages = (static_cast<int>(m_order.size()) + maxRows() - 1) / maxRows();
+    m_page = std::max(0, std::min(m_page, total_pages - 1));
+
+    m_ordered = std::min(m_order.size(), static_cast<size_t>((m_page + 1) * maxRows()));
+    auto order = [&](auto key){
+        std::partial_sort(m_order.begin(), m_order.begin() + m_ordered, m_order.end(), [&](int a, int b){
+            double ka = key(net[a]), kb = key(net[b]);
+            if (ka != kb) return ka > kb;
+            return a < b;
+        });
+    };
+
+    switch (m_sort_key){
+        case NetSortKey::Rx:
+            order([](const NetStat &n){ return n.rx_rate; });
+            break;
+        case NetSortKey::Tx:
+            order([](const NetStat &n){ return n.tx_rate; });
+            break;
+        case NetSortKey::Name:
+            std::partial_sort(m_order.begin(), m_order.begin() + m_ordered, m_order.end(), [&](int a, int b){
+                int cmp = net[a].name.compare(net[b].name);
+                return cmp != 0 ? cmp < 0 : a < b;
+            });
+            break;
+        default:
+            order([](const NetStat &n){ return throughput(n); });
+            break;
+    }
+}
+
+int NetPanel::footer(char *line, size_t size, int total_pages) const{
+    if (m_editing){
+        return snprintf(line, size, "/%s_ | %zu match | enter/esc", m_filter_text.c_str(), m_order.size());
+    }
+    size_t total = m_snapshot ? m_snapshot->net.size() : 0;
+    const char *idle_key = m_hide_idle ? "a show idle" : "a hide idle";
+    if (!m_filter_text.empty()){
+        return snprintf(line, size, "page %d/%d | %zu of %zu interfaces | filter: %s | %s | sort: %s (b/r/t/n) | i processes", m_page+1, total_pages, m_order.size(), total,
+                        m_filter_text.c_str(), idle_key, netSortKeyName(m_sort_key));
+    }
+    return snprintf(line, size, "page %d/%d | %zu of %zu interfaces | / filter | %s | sort: %s (b/r/t/n) | i processes", m_page+1, total_pages, m_order.size(), total,
+                    idle_key, netSortKeyName(m_sort_key));
+}
+
+void NetPanel::drawVisuals(){
+    const std::vector<NetStat> &net = m_snapshot->net;
+    int win_width = getmaxx(win);
+
+    char line[1024];
+    int len;
+
+    // the name takes what is left after the rates, and the totals once there is room for them
+    int inner = win_width - 4;
+    bool totals = inner >= 16 + 8 * (NET_COLUMN_WIDTH + 1);
+    int name_width = std::max(8, std::min(32, inner - (totals ? 8 : 6) * (NET_COLUMN_WIDTH + 1)));
+
+    // column header and divider, unchanged until the layout changes
+    len = snprintf(line, sizeof(line), "%-*s %*s %*s %*s %*s %*s %*s", name_width, "IFACE", NET_COLUMN_WIDTH, "RX/s", NET_COLUMN_WIDTH, "TX/s",
+                   NET_COLUMN_WIDTH, "RXPKT/s", NET_COLUMN_WIDTH, "TXPKT/s", NET_COLUMN_WIDTH, "DROP/s", NET_COLUMN_WIDTH, "ERR/s");
+    if (totals){
+        len += snprintf(line + len, sizeof(line) - len, " %*s %*s", NET_COLUMN_WIDTH, "RX", NET_COLUMN_WIDTH, "TX");
+    }
+    if (rowChanged(1, line, len)){
+        mvwhline(win, 1, 2, ' ', win_width - 4);
+        wattron(win, A_BOLD | COLOR_PAIR(7));
+        mvwaddnstr(win, 1, 2, line, std::min(len, std::max(win_width - 4, 0)));
+        wattroff(win, A_BOLD | COLOR_PAIR(7));
+
+        mvwhline(win, 2, 2, '-', win_width - 4);
+    }
+
+    int max_rows = maxRows();
+    int start = m_page * max_rows;
+    int end = std::min(start + max_rows, static_cast<int>(m_ordered));
+
+    for (int row = 3; row < 3 + max_rows; ++row){
+        int i = start + row - 3;
+
+        if (m_order.empty() && row == 3){
+            len = snprintf(line, sizeof(line), "%s", net.empty() ? "no interfaces (/proc/net/dev could not be read)" : "no interfaces match");
+            if (rowChanged(row, line, len)){
+                mvwhline(win, row, 2, ' ', win_width - 4);
+                mvwaddnstr(win, row, 2, line, std::min(len, std::max(win_width - 4, 0)));
+            }
+            continue;
+        }
+
+        if (i >= end){
+            if (rowChanged(row, "", 0)){
+                mvwhline(win, row, 2, ' ', win_width - 4);
+            }
+            continue;
+        }
+
+        const NetStat &n = net[m_order[i]];
+
+        // losing packets stands out, idle interfaces fade into the background
+        int color = n.drop_rate > 0.0 || n.error_rate > 0.0 ? 3 : idle(n) ? 8 : throughput(n) > 10.0 * 1024 * 1024 ? 2 : 0;
+
+        // "-" until the interface has been seen in two samples
+        char rates[6][16];
+        const double values[6] = {n.rx_rate, n.tx_rate, n.rx_packet_rate, n.tx_packet_rate, n.drop_rate, n.error_rate};
+        for (int c = 0; c < 6; ++c){
+            if (n.has_rate){
+                formatRate(rates[c], sizeof(rates[c]), values[c]);
+            } else {
+                snprintf(rates[c], sizeof(rates[c]), "-");
+            }
+        }
+
+        line[0] = static_cast<char>('0' + color);
+        len = snprintf(line + 1, sizeof(line) - 1, "%-*.*s %*s %*s %*s %*s %*s %*s", name_width, name_width, n.name.c_str(), NET_COLUMN_WIDTH, rates[0], NET_COLUMN_WIDTH, rates[1],
+                       NET_COLUMN_WIDTH, rates[2], NET_COLUMN_WIDTH, rates[3], NET_COLUMN_WIDTH, rates[4], NET_COLUMN_WIDTH, rates[5]);
+        len = std::min<int>(len, sizeof(line) - 2) + 1;
+        if (totals){
+            char rx[16], tx[16];
+            formatRate(rx, sizeof(rx), static_cast<double>(n.counters.rx_bytes));
+            formatRate(tx, sizeof(tx), static_cast<double>(n.counters.tx_bytes));
+            len += snprintf(line + len, sizeof(line) - len, " %*s %*s", NET_COLUMN_WIDTH, rx, NET_COLUMN_WIDTH, tx);
+            len = std::min<int>(len, sizeof(line) - 1);
+        }
+
+        if (!rowChanged(row, line, len)){
+            continue;
+        }
+
+        mvwhline(win, row, 2, ' ', win_width - 4);
+        wattron(win, COLOR_PAIR(color));
+        mvwaddnstr(win, row, 2, line + 1, std::min(len - 1, std::max(win_width - 4, 0)));
+        wattroff(win, COLOR_PAIR(color));
+    }
+
+    int total_pages = std::max(1, (static_cast<int>(m_order.size()) + max_rows - 1)/max_rows);
+    len = footer(line, sizeof(line), total_pages);
+    len = std::min<int>(len, sizeof(line) - 1);
+    len = std::min(len, std::max(win_width - 4, 0));
+    if (rowChanged(m_height - 1, line, len)){
+        clearBottomBorder();
+        mvwaddnstr(win, m_height-1, 2, line, len);
+    }
+}
+
+NetPanel::NetPanel(
+    int height, // height of the panel
+    int width, // width of the panel
+    int y, // y coordinate of the panel
+    int x // x coordinate of the panel
+)
+:
+Panel(
+    "net", // title
+    6, // color pair
+    height,
+    width,
+    y,
+    x) {}
+
+void NetPanel::drawNet(std::shared_ptr<const SystemSnapshot> snapshot){
+    if (snapshot != m_snapshot){
+        m_snapshot = std::move(snapshot);
+        orderInterfaces();
+    }
+
+    drawPanel();
+    drawVisuals();
+    wnoutrefresh(win);
+}
+
+void NetPanel::changePage(int direction){
+    m_page += direction;
+    if (m_snapshot){
+        orderInterfaces(); // clamps the page, and orders the rows it brings into view
+    }
+}
+
+void NetPanel::setSortKey(NetSortKey key){
+    m_sort_key = key;
+    m_page = 0;
+    if (m_snapshot){
+        orderInterfaces();
+    }
+}
+
+void NetPanel::toggleIdle(){
+    m_hide_idle = !m_hide_idle;
+    if (m_snapshot){
+        orderInterfaces();
+    }
+}
+
+void NetPanel::startFilter(){
+    m_editing = true;
+    m_filter_before = m_filter_text;
+}
+
+void NetPanel::editFilter(int ch){
+    if (ch == '\n' || ch == KEY_ENTER){
+        m_editing = false;
+        return;
+    }
+    if (ch == 27){
+        m_editing = false;
+        m_filter_text = m_filter_before;
+    } else if (ch == KEY_BACKSPACE || ch == 127 || ch == 8){
+        if (m_filter_text.empty()){
+            return;
+        }
+        m_filter_text.pop_back();
+    } else if (ch == 21){ // ctrl-u
+        m_filter_text.clear();
+    } else if (ch >= 0x20 && ch < 0x7f){
+        m_filter_text.push_back(static_cast<char>(ch));
+    } else {
+        return;
+    }
+    m_page = 0;
+    if (m_snapshot){
+        orderInterfaces();
+    }
+}
+
+// ─────────────────────────────────────────────
+// MemPanel
+// ─────────────────────────────────────────────
+
+void MemPanel::getMemStats(const MemStat &mem){
+    m_mem_info = mem;
+
+    // cached can exceed used (it includes reclaimable pages), so clamping at zero
+    unsigned long long reclaimable = m_mem_info.buffers_kb + m_mem_info.cached_kb;
+    m_active_memory = m_mem_info.used_kb > reclaimable ? m_mem_info.used_kb - reclaimable : 0;
+    m_buffer = m_mem_info.buffers_kb;
+    m_cached = m_mem_info.cached_kb;
+    m_free = m_mem_info.free_kb;
+    m_total = m_mem_info.total_kb;
+}
+
+std::vector<int> MemPanel::calculateBars(int container_width, const unsigned long long& total_memory, const unsigned long long& active_memory, const unsigned long long& buffer, const unsigned long long& cached){
+
+    if (total_memory == 0) {
+        return {0, 0, 0, 0};
+    }
+
+    int active_memory_bars = static_cast<int>(container_width * (static_cast<double>(active_memory) / total_memory));
+    int buffer_memory_bars = static_cast<int>(container_width * (static_cast<double>(buffer) / total_memory));
+    int cached_memory_bars = static_cast<int>(container_width * (static_cast<double>(cached) / total_memory));
+
+    return {active_memory_bars, buffer_memory_bars, cached_memory_bars};
+}
+
+void MemPanel::drawAmount(int row, int color, const char *label, unsigned long long kb){
+    double gb = static_cast<double>(kb) / (1024 * 1024);
+
+    char text[64];
+    int len = snprintf(text, sizeof(text), "%s %.2fG", label, gb);
+    if (!rowChanged(row, text, len)){
+        return;
+    }
+
+    mvwhline(win, row, 1, ' ', getmaxx(win) - 2);
+    wattron(win, COLOR_PAIR(color) | A_BOLD);
+    mvwprintw(win, row, 2, "%s", label);
+    wattroff(win, COLOR_PAIR(color) | A_BOLD);
+    wprintw(win," %.2fG", gb);
+}
+
+void MemPanel::drawVisuals(const MemStat &mem, const History &history){
+    // calculating width of the bar container
+    int bar_container_width = getmaxx(win) - 6;
+
+    // getting memory stats
+    getMemStats(mem);
+
+    // calculating bars
+    std::vector<int> barsCount = calculateBars(bar_container_width, m_total, m_active_memory, m_buffer, m_cached);
+
+    // the bar only changes when one of its segments gains or loses a bar
+    char key[64];
+    int key_len = snprintf(key, sizeof(key), "%d %d %d %d", bar_container_width, barsCount[0], barsCount[1], barsCount[2]);
+    if (rowChanged(1, key, key_len)){
+        // setting bars
+        std::string active_bars(barsCount[0], '|');
+        std::string buffer_bars(barsCount[1], '|');
+        std::string cached_bars(barsCount[2], '|');
+        // free 'spaces'
+        int used = barsCount[0] + barsCount[1] + barsCount[2];
+        int free_bar_count = bar_container_width - used;
+        std::string free_bars(std::max(0, free_bar_count), ' ');
+
+
+        // drawing the bars
+        mvwprintw(win, 1, 2, "[");
+
+        wattron(win, COLOR_PAIR(1) | A_BOLD);
+        wprintw(win, "%s", active_bars.c_str());
+        wattroff(win, COLOR_PAIR(1) | A_BOLD);
+
+        wattron(win, COLOR_PAIR(4) | A_BOLD);
+        wprintw(win, "%s", buffer_bars.c_str());
+        wattroff(win, COLOR_PAIR(4) | A_BOLD);
+
+        wattron(win, COLOR_PAIR(2) | A_BOLD);
+        wprintw(win, "%s", cached_bars.c_str());
+        wattroff(win, COLOR_PAIR(2) | A_BOLD);
+
+        wprintw(win, "%s", free_bars.c_str());
+
+        wprintw(win, "]");
+    }
+
+
+    // used memory over time, under the bar
+    if (history.size() > 0 && bar_container_width > 0){
+        m_trend.resize(bar_container_width);
+        m_spark.resize(bar_container_width);
+        size_t n = history.mem(MemSeries::Used, m_trend.data(), bar_container_width);
+        formatSparkline(&m_spark[0], m_trend.data(), n, bar_container_width, 0.0f, 100.0f);
+        if (rowChanged(2, m_spark.data(), m_spark.size())){
+            wattron(win, COLOR_PAIR(1));
+            mvwaddnstr(win, 2, 3, m_spark.data(), static_cast<int>(m_spark.size()));
+            wattroff(win, COLOR_PAIR(1));
+        }
+    }
+
+    // drawing usage stats
+    double used_gb  = static_cast<double>(m_mem_info.used_kb)  / (1024 * 1024);
+    double total_gb = static_cast<double>(m_mem_info.total_kb) / (1024 * 1024);
+    char usage[64];
+    int usage_len = snprintf(usage, sizeof(usage), "Usage: %.2fG/%.1fG", used_gb, total_gb);
+    drawTextRow(3, 2, usage, usage_len);
+
+    drawAmount(5, 1, "Active:\t", m_active_memory); // active memory
+    drawAmount(6, 4, "Buffer: \t", m_buffer); // buffer
+    drawAmount(7, 2, "Cache:\t", m_cached); // cached memory
+    drawAmount(8, 8, "Free: \t", m_free); // free memory
+}
+
+MemPanel::MemPanel(
+    int height, // height of the panel
+    int width, // width of the panel
+    int y, // y coordinate of the panel
+    int x // x coordinate of the panel
+)
+:
+Panel(
+    "mem", // title
+    5, // color pair
+    height,
+    width,
+    y,
+    x) {}
+
+void MemPanel::drawMemStats(const SystemSnapshot &snapshot, const History &history){
+    // drawing the memory panel first
+    drawPanel();
+
+    // drawing visuals
+    drawVisuals(snapshot.mem, history);
+
+    wnoutrefresh(win); // refreshing window (mem panel contents)
+
+}
+
+// ─────────────────────────────────────────────
+// PressurePanel
+// ─────────────────────────────────────────────
+
+// width of the pressure panel's resource names column
+static const int PRESSURE_LABEL_WIDTH = 7;
+
+// stall time in at most 6 characters: 850us, 12ms, 1.5s
+static void formatStallTime(char *out, size_t size, unsigned long long us){
+    if (us < 1000){
+        snprintf(out, size, "%lluus", us);
+    } else if (us < 1000000){
+        snprintf(out, size, "%llums", us / 1000);
+    } else {
+        snprintf(out, size, "%.1fs", us / 1000000.0);
+    }
+}
+
+int PressurePanel::levelColor(float percent){
+    if (percent < 1.0f){
+        return 8;
+    }
+    if (percent < 10.0f){
+        return 1;
+    }
+    return percent < 25.0f ? 2 : 3;
+}
+
+void PressurePanel::lineCells(const PressureLine &line, bool present, bool has_delta, Cell *cells){
+    if (!present){
+        for (int i = 0; i < 4; ++i){
+            snprintf(cells[i].text, sizeof(cells[i].text), "-");
+            cells[i].color = 8;
+        }
+        return;
+    }
+
+    snprintf(cells[0].text, sizeof(cells[0].text), "%.1f%%", line.avg10);
+    cells[0].color = levelColor(line.avg10);
+    snprintf(cells[1].text, sizeof(cells[1].text), "%.1f%%", line.avg60);
+    cells[1].color = levelColor(line.avg60);
+
+    if (!has_delta){
+        snprintf(cells[2].text, sizeof(cells[2].text), "-");
+        snprintf(cells[3].text, sizeof(cells[3].text), "-");
+        cells[2].color = cells[3].color = 8;
+        return;
+    }
+    snprintf(cells[2].text, sizeof(cells[2].text), "%.1f%%", line.interval_percent);
+    formatStallTime(cells[3].text, sizeof(cells[3].text), line.delta_us);
+    cells[2].color = cells[3].color = levelColor(line.interval_percent);
+}
+
+int PressurePanel::cellWidth() const{
+    return std::min(10, std::max(7, (getmaxx(win) - 4 - PRESSURE_LABEL_WIDTH) / 8));
+}
+
+void PressurePanel::drawHeader(int cell_width){
+    // "some" and "full" on the top border over their columns, the field names under it
+    char key[32];
+    int key_len = snprintf(key, sizeof(key), "%d", cell_width);
+    if (!rowChanged(1, key, key_len)){
+        return;
+    }
+
+    int x = 2 + PRESSURE_LABEL_WIDTH;
+    for (const char *kind : {"some", "full"}){
+        mvwprintw(win, 0, x + 4 * cell_width - 6, " %s ", kind);
+
+        wattron(win, A_BOLD);
+        for (const char *field : {"avg10", "avg60", "now", "stall"}){
+            mvwprintw(win, 1, x, "%*s", cell_width, field);
+            x += cell_width;
+        }
+        wattroff(win, A_BOLD);
+    }
+}
+
+void PressurePanel::drawResource(int row, PressureResource resource, const PressureStat &stat, int cell_width){
+    const char *name = pressureResourceName(resource);
+
+    Cell cells[8];
+    if (stat.valid){
+        lineCells(stat.some, true, stat.has_delta, cells);
+        lineCells(stat.full, stat.has_full, stat.has_delta, cells + 4);
+    }
+
+    // the colours go into the row key too, a value can change level without changing its text
+    char key[256];
+    size_t key_len = snprintf(key, sizeof(key), "%s %d", name, stat.valid ? cell_width : -1);
+    for (int i = 0; stat.valid && i < 8; ++i){
+        key_len += snprintf(key + key_len, sizeof(key) - key_len, "|%c%s", '0' + cells[i].color, cells[i].text);
+    }
+    if (!rowChanged(row, key, std::min(key_len, sizeof(key) - 1))){
+        return;
+    }
+
+    mvwhline(win, row, 1, ' ', getmaxx(win) - 2);
+    if (!stat.valid){
+        mvwprintw(win, row, 2, "%-*s", PRESSURE_LABEL_WIDTH, name);
+        wattron(win, COLOR_PAIR(8));
+        wprintw(win, "not reported by this kernel");
+        wattroff(win, COLOR_PAIR(8));
+        return;
+    }
+
+    // the label takes the colour of the worst "some" reading
+    int label_color = levelColor(std::max(stat.some.avg10, stat.has_delta ? stat.some.interval_percent : 0.0f));
+    wattron(win, COLOR_PAIR(label_color) | A_BOLD);
+    mvwprintw(win, row, 2, "%-*s", PRESSURE_LABEL_WIDTH, name);
+    wattroff(win, COLOR_PAIR(label_color) | A_BOLD);
+
+    for (const Cell &cell : cells){
+        wattron(win, COLOR_PAIR(cell.color));
+        wprintw(win, "%*s", cell_width, cell.text);
+        wattroff(win, COLOR_PAIR(cell.color));
+    }
+}
+
+PressurePanel::PressurePanel(
+    int height, // height of the panel
+    int width, // width of the panel
+    int y, // y coordinate of the panel
+    int x // x coordinate of the panel
+)
+:
+Panel(
+    "pressure", // title
+    3, // color pair
+    height,
+    width,
+    y,
+    x) {}
+
+bool PressurePanel::available(const SystemSnapshot &snapshot){
+    for (const PressureStat &stat : snapshot.pressure){
+        if (stat.valid){
+            return true;
+        }
+    }
+    return false;
+}
+
+void PressurePanel::drawPressure(const SystemSnapshot &snapshot){
+    // drawing the pressure panel first
+    drawPanel();
+
+    int cell_width = cellWidth();
+    drawHeader(cell_width);
+    for (size_t i = 0; i < PRESSURE_RESOURCES; ++i){
+        drawResource(2 + static_cast<int>(i), static_cast<PressureResource>(i), snapshot.pressure[i], cell_width);
+    }
+
+    wnoutrefresh(win); // refreshing window (pressure panel contents)
+}
+
+// ─────────────────────────────────────────────
+// CPUPanel
+// ─────────────────────────────────────────────
+
+// shortest bar a core gets in the column grid
+static const int CPU_CELL_MIN_BARS = 5;
+
+// heatmap characters, one per 10% of usage
+static const char CPU_HEAT_LEVELS[] = "._-:=+*#%@";
+
+// heatmap row label: the group on its first row, then the number of the row's first core
+static const int CPU_HEAT_LABEL_WIDTH = 12;
+
+std::string CPUPanel::generateBars(int container_width, double utilization_percent) {
+    if (container_width <= 0){
+        return "";
+    }
+
+    // normalizing to 0..1
+    double utilization = utilization_percent / 100.0;
+
+    // containing
+    if (utilization < 0.0){
+        utilization = 0.0;
+    }
+    if (utilization > 1.0){
+        utilization = 1.0;
+    }
+
+    int total_bars = (container_width * utilization);
+    int total_space = container_width - total_bars;
+
+    return std::string(total_bars, '|') + std::string(total_space, ' ');
+}
+
+int CPUPanel::getColor(double utilization){
+    if (utilization <= 50){
+        return 1;
+    } else if (utilization <= 80){
+        return 2;
+    } else {
+        return 3;
+    }
+}
+
+double CPUPanel::clampUsage(double utilization){
+    return std::min(std::max(utilization, 0.0), 100.0);
+}
+
+int CPUPanel::cpuName(int id, char *out, size_t size){
+    return id < 0 ? snprintf(out, size, "cpu") : snprintf(out, size, "cpu%d", id);
+}
+
+void CPUPanel::drawBreakdown(const CpuUsage &cpu){
+    static const CpuField FIELDS[] = {CpuField::User, CpuField::System, CpuField::Iowait, CpuField::Steal,
+        CpuField::Nice, CpuField::Irq, CpuField::Softirq, CpuField::Guest};
+    static const char *const LABELS[] = {"usr", "sys", "iow", "st", "nic", "irq", "sirq", "gst"};
+
+    int room = std::max(getmaxx(win) - 4, 0);
+    char text[128];
+    int len = 0;
+    for (size_t i = 0; i < sizeof(FIELDS) / sizeof(FIELDS[0]); ++i){
+        char field[24];
+        int field_len = snprintf(field, sizeof(field), "%s%s %.1f", len > 0 ? "  " : "", LABELS[i], cpu.field(FIELDS[i], 0));
+        if (len + field_len > room || len + field_len >= static_cast<int>(sizeof(text))){
+            break;
+        }
+        std::memcpy(text + len, field, field_len);
+        len += field_len;
+    }
+    drawTextRow(1, 2, text, len);
+}
+
+void CPUPanel::drawVisual(const CpuUsage &cpu, size_t core, int row, const History &history) {
+    // CPU name and utilization
+    char cpu_title[16];
+    cpuName(cpu.ids[core], cpu_title, sizeof(cpu_title));
+    double utilization = clampUsage(cpu.busy[core]);
+
+    // calculating width for the bars container
+    int window_width = getmaxx(win);
+
+    // left margin + cpu title length + ' [' + '] ' + percentage + right margin
+    int fixed_width = 2 + 6 + 2 + 2 + 7 + 2;
+
+    // a third of the room left goes to the usage sparkline once there is history
+    int spark_width = history.size() > 0 ? std::min<int>(history.capacity(), (window_width - fixed_width) / 3) : 0;
+    spark_width = std::max(spark_width, 0);
+
+    int bars_container_width = window_width - fixed_width - (spark_width > 0 ? spark_width + 1 : 0);
+    if (bars_container_width < 1) bars_container_width = 1;
+
+    m_spark.assign(spark_width, ' ');
+    if (spark_width > 0){
+        m_trend.resize(spark_width);
+        size_t n = history.coreUsage(core, m_trend.data(), spark_width);
+        formatSparkline(&m_spark[0], m_trend.data(), n, spark_width, 0.0f, 100.0f);
+    }
+
+    // skipping the row if it would look the same as in the last frame
+    // (same bar length, color, printed percentage and sparkline)
+    m_key.resize(64 + m_spark.size());
+    int key_len = snprintf(&m_key[0], m_key.size(), "%s %d %d %6.2f %s", cpu_title,
+        static_cast<int>(bars_container_width * utilization / 100.0), bars_container_width, utilization, m_spark.c_str());
+    if (!rowChanged(row, m_key.data(), std::min<size_t>(key_len, m_key.size() - 1))){
+        return;
+    }
+
+    // generating visual bar string
+    std::string bars = generateBars(bars_container_width, utilization);
+
+    // getting color pair
+    int color_pair = getColor(utilization);
+
+    // displaying CPU info
+    mvwprintw(win, row, 2, "%-5s [", cpu_title);
+    wattron(win, COLOR_PAIR(color_pair) | A_BOLD);
+    wprintw(win, "%s", bars.c_str());
+    wattroff(win, COLOR_PAIR(color_pair) | A_BOLD);
+    wprintw(win, "] %6.2f%%", utilization); // fixed width percentage
+
+    if (spark_width > 0){
+        wattron(win, COLOR_PAIR(color_pair));
+        wprintw(win, " %s", m_spark.c_str());
+        wattroff(win, COLOR_PAIR(color_pair));
+    }
+}
+
+void CPUPanel::drawColumnsRow(const CpuUsage &cpu, const CpuLayout &layout, int r, int row){
+    size_t cores = cpu.rows() - 1;
+    int bars_width = layout.cell_width - m_name_width - 8;
+
+    // key: name, bar length, color and printed percentage of every cell
+    m_key.clear();
+    for (int c = 0; c < layout.cells_per_row; ++c){
+        size_t index = static_cast<size_t>(c) * layout.rows + r;
+        if (index >= cores){
+            break;
+        }
+        double utilization = clampUsage(cpu.busy[index + 1]);
+        char cell[64];
+        int len = snprintf(cell, sizeof(cell), "%d %d %d %.0f|", cpu.ids[index + 1],
+            static_cast<int>(bars_width * utilization / 100.0), getColor(utilization), utilization);
+        m_key.append(cell, std::min<size_t>(len, sizeof(cell) - 1));
+    }
+    if (!rowChanged(row, m_key.data(), m_key.size())){
+        return;
+    }
+
+    mvwhline(win, row, 1, ' ', getmaxx(win) - 2);
+    for (int c = 0; c < layout.cells_per_row; ++c){
+        size_t index = static_cast<size_t>(c) * layout.rows + r;
+        if (index >= cores){
+            break;
+        }
+        double utilization = clampUsage(cpu.busy[index + 1]);
+        int color_pair = getColor(utilization);
+
+        char name[16];
+        cpuName(cpu.ids[index + 1], name, sizeof(name));
+        mvwprintw(win, row, 2 + c * (layout.cell_width + 1), "%-*s [", m_name_width, name);
+        wattron(win, COLOR_PAIR(color_pair) | A_BOLD);
+        wprintw(win, "%s", generateBars(bars_width, utilization).c_str());
+        wattroff(win, COLOR_PAIR(color_pair) | A_BOLD);
+        wprintw(win, "]%4.0f%%", utilization);
+    }
+}
+
+void CPUPanel::drawHeatmapRow(const CpuUsage &cpu, const CpuLayout &layout, const CoreGroup &group, size_t first_cell, size_t cells, int row){
+    const std::vector<size_t> &cores = group.cores;
+
+    char label[32];
+    snprintf(label, sizeof(label), "%-6.6s%5d ", first_cell == 0 ? group.label.c_str() : "",
+        cpu.ids[cores[first_cell * layout.cores_per_cell]]);
+
+    // every cell is the average of its cores, the row is kept as characters followed by their colors
+    m_heat.resize(2 * cells);
+    for (size_t cell = 0; cell < cells; ++cell){
+        size_t begin = (first_cell + cell) * layout.cores_per_cell;
+        size_t end = std::min(begin + layout.cores_per_cell, cores.size());
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i){
+            sum += clampUsage(cpu.busy[cores[i]]);
+        }
+        double utilization = sum / (end - begin);
+        m_heat[cell] = CPU_HEAT_LEVELS[std::min(static_cast<int>(utilization / 10.0), 9)];
+        m_heat[cells + cell] = static_cast<char>('0' + getColor(utilization));
+    }
+
+    m_key.assign(label);
+    m_key += m_heat;
+    if (!rowChanged(row, m_key.data(), m_key.size())){
+        return;
+    }
+
+    mvwhline(win, row, 1, ' ', getmaxx(win) - 2);
+    mvwaddstr(win, row, 2, label);
+
+    // one attribute change per run of cells of the same color
+    size_t run = 0;
+    for (size_t cell = 1; cell <= cells; ++cell){
+        if (cell < cells && m_heat[cells + cell] == m_heat[cells + run]){
+            continue;
+        }
+        int color_pair = m_heat[cells + run] - '0';
+        wattron(win, COLOR_PAIR(color_pair) | A_BOLD);
+        waddnstr(win, m_heat.data() + run, static_cast<int>(cell - run));
+        wattroff(win, COLOR_PAIR(color_pair) | A_BOLD);
+        run = cell;
+    }
+}
+
+void CPUPanel::updateGroups(const CpuUsage &cpu){
+    if (cpu.rows() == m_grouped_cpus){
+        return;
+    }
+    m_grouped_cpus = cpu.rows();
+
+    m_name_width = 5;
+    std::vector<std::pair<int, size_t>> keyed; // (group, core), cores in /proc/stat order within a group
+    for (size_t i = 1; i < cpu.rows(); ++i){
+        char name[16];
+        m_name_width = std::max(m_name_width, cpuName(cpu.ids[i], name, sizeof(name)));
+        keyed.push_back({m_topology.group(m_grouping, cpu.ids[i]), i});
+    }
+    std::stable_sort(keyed.begin(), keyed.end(), [](const std::pair<int, size_t> &a, const std::pair<int, size_t> &b){
+        return a.first < b.first;
+    });
+
+    const char *prefix = m_grouping == CpuGrouping::Node ? "node" : "sock";
+    m_groups.clear();
+    for (size_t i = 0; i < keyed.size(); ++i){
+        if (i == 0 || keyed[i].first != keyed[i - 1].first){
+            int id = keyed[i].first;
+            std::string label = m_grouping == CpuGrouping::None ? "" : id < 0 ? "?" : prefix + std::to_string(id);
+            m_groups.push_back({label, {}});
+        }
+        m_groups.back().cores.push_back(keyed[i].second);
+    }
+}
+
+size_t CPUPanel::heatmapRows(size_t per_cell, size_t chars) const{
+    size_t rows = 0;
+    for (const CoreGroup &group : m_groups){
+        size_t cells = (group.cores.size() + per_cell - 1) / per_cell;
+        rows += (cells + chars - 1) / chars;
+    }
+    return rows;
+}
+
+CpuLayout CPUPanel::layoutFor(size_t cores, int width, int body_rows) const{
+    int inner = std::max(width - 4, 1);
+    body_rows = std::max(body_rows, 1);
+
+    if (cores <= static_cast<size_t>(body_rows)){
+        return {CpuLayoutMode::Bars, static_cast<int>(cores), 1, inner, 1};
+    }
+
+    // name + ' [' + bars + ']' + percentage, one space between cells
+    int cell_min = m_name_width + 2 + CPU_CELL_MIN_BARS + 1 + 5;
+    int columns = (inner + 1) / (cell_min + 1);
+    if (columns >= 2){
+        size_t rows = (cores + columns - 1) / columns;
+        if (rows <= static_cast<size_t>(body_rows)){
+            return {CpuLayoutMode::Columns, static_cast<int>(rows), columns, (inner + 1) / columns - 1, 1};
+        }
+    }
+
+    // fewest cores per character that still fit, a group per row at the very least
+    size_t chars = static_cast<size_t>(std::max(inner - CPU_HEAT_LABEL_WIDTH, 1));
+    size_t per_cell = 1;
+    while (per_cell < cores && heatmapRows(per_cell, chars) > static_cast<size_t>(body_rows)){
+        ++per_cell;
+    }
+    return {CpuLayoutMode::Heatmap, static_cast<int>(heatmapRows(per_cell, chars)), static_cast<int>(chars), 0, per_cell};
+}
+
+CPUPanel::CPUPanel(
+    int height, // height of the panel
+    int width, // width of the panel
+    int y, // y coordinate of the panel
+    int x // x coordinate of the panel
+)
+:
+Panel(
+    "cpu", // title
+    4, // color pair
+    height,
+    width,
+    y,
+    x) {}
+
+void CPUPanel::setTopology(const CpuTopology &topology, CpuGrouping grouping){
+    m_topology = topology;
+    m_grouping = topology.resolve(grouping);
+    m_grouped_cpus = 0;
+}
+
+int CPUPanel::fitHeight(const SystemSnapshot &snapshot, int width, int max_height){
+    updateGroups(snapshot.cpu);
+    size_t cores = snapshot.cpu.empty() ? 0 : snapshot.cpu.rows() - 1;
+    return layoutFor(cores, width, max_height - CPU_PANEL_CHROME).rows + CPU_PANEL_CHROME;
+}
+
+void CPUPanel::drawCPUStats(const SystemSnapshot &snapshot, const History &history){
+    const CpuUsage &delta_results = snapshot.cpu;
+
+    // drawing the cpu panel first
+    drawPanel();
+
+    // main cpu stat
+    if (!delta_results.empty()){
+        drawBreakdown(delta_results);
+        drawVisual(delta_results, 0, 2, history);
+
+        // divider, drawn again only after a layout change
+        if (rowChanged(3, "-", 1)){
+            mvwhline(win, 3, 2, '-', getmaxx(win) - 4);
+        }
+
+        updateGroups(delta_results);
+        int last_row = getmaxy(win) - 2;
+        CpuLayout layout = layoutFor(delta_results.rows() - 1, getmaxx(win), getmaxy(win) - CPU_PANEL_CHROME);
+
+        if (layout.mode == CpuLayoutMode::Bars){
+            size_t row = 4;
+            for (size_t i=1; i<delta_results.rows(); ++i){
+                drawVisual(delta_results, i, row++, history);
+            }
+        } else if (layout.mode == CpuLayoutMode::Columns){
+            for (int r = 0; r < layout.rows && 4 + r <= last_row; ++r){
+                drawColumnsRow(delta_results, layout, r, 4 + r);
+            }
+        } else {
+            int row = 4;
+            for (const CoreGroup &group : m_groups){
+                size_t cells = (group.cores.size() + layout.cores_per_cell - 1) / layout.cores_per_cell;
+                for (size_t first = 0; first < cells && row <= last_row; first += layout.cells_per_row){
+                    drawHeatmapRow(delta_results, layout, group, first, std::min<size_t>(layout.cells_per_row, cells - first), row++);
+                }
+            }
+        }
+    }
+
+
+    wnoutrefresh(win); // refreshing window (cpu panel contents)
+}
+
+// ─────────────────────────────────────────────
+// ProfilePanel
+// ─────────────────────────────────────────────
+
+void ProfilePanel::formatDuration(char *buf, size_t size, uint64_t ns){
+    if (ns < 1000){
+        snprintf(buf, size, "%lluns", static_cast<unsigned long long>(ns));
+    } else if (ns < 1000000){
+        snprintf(buf, size, "%.1fus", ns / 1e3);
+    } else if (ns < 1000000000){
+        snprintf(buf, size, "%.2fms", ns / 1e6);
+    } else {
+        snprintf(buf, size, "%.2fs", ns / 1e9);
+    }
+}
+
+void ProfilePanel::formatHistogram(char *buf, const Profiler::Summary &summary){
+    static const char LEVELS[] = " .:-=+*#@";
+    uint32_t most = *std::max_element(summary.buckets, summary.buckets + Profiler::BUCKETS);
+    for (size_t b = 0; b < Profiler::BUCKETS; ++b){
+        uint32_t count = summary.buckets[b];
+        size_t level = count == 0 ? 0 : 1 + count * (sizeof(LEVELS) - 3) / most;
+        buf[b] = LEVELS[level];
+    }
+    buf[Profiler::BUCKETS] = '\0';
+}
+
+int ProfilePanel::height(){
+    return static_cast<int>(Stage::Count) + 4;
+}
+
+int ProfilePanel::width(){
+    return 80;
+}
+
+ProfilePanel::ProfilePanel(int y, int x)
+:
+Panel(
+    "vtop self", // title
+    5, // color pair
+    height(),
+    width(),
+    y,
+    x) {}
+
+void ProfilePanel::drawProfile(const SelfUsage &self, unsigned long long frame_bytes){
+    drawPanel();
+
+    char line[256];
+    int len = snprintf(line, sizeof(line), "cpu %.1f%%  rss %lu KB  threads %lu  tty %llu B/frame",
+        self.cpuPercent(), self.rssKB(), self.threads(), frame_bytes);
+    drawTextRow(1, 2, line, std::min<size_t>(len, sizeof(line) - 1));
+
+    len = snprintf(line, sizeof(line), "%-14s %7s %7s %7s %7s  %s", "stage", "last", "p50", "p99", "max", "<1us      ~1ms      ~1s");
+    if (rowChanged(2, line, len)){
+        wattron(win, A_BOLD);
+        mvwaddnstr(win, 2, 2, line, len);
+        wattroff(win, A_BOLD);
+    }
+
+    Profiler::Summary summary;
+    char last[16], p50[16], p99[16], max[16], histogram[Profiler::BUCKETS + 1];
+    for (size_t i = 0; i < static_cast<size_t>(Stage::Count); ++i){
+        Stage stage = static_cast<Stage>(i);
+        profiler().summarize(stage, summary);
+
+        if (summary.count == 0){
+            len = snprintf(line, sizeof(line), "%-14s %7s", stageName(stage), "-");
+        } else {
+            formatDuration(last, sizeof(last), summary.last);
+            formatDuration(p50, sizeof(p50), summary.p50);
+            formatDuration(p99, sizeof(p99), summary.p99);
+            formatDuration(max, sizeof(max), summary.max);
+            formatHistogram(histogram, summary);
+            len = snprintf(line, sizeof(line), "%-14s %7s %7s %7s %7s  %s", stageName(stage), last, p50, p99, max, histogram);
+        }
+        drawTextRow(3 + static_cast<int>(i), 2, line, std::min<size_t>(len, sizeof(line) - 1));
+    }
+
+    // drawn over the proc panel, so every line is copied again whatever it redrew underneath
+    touchwin(win);
+    wnoutrefresh(win);
+}
+
+// ─────────────────────────────────────────────
+// MainPanel
+// ─────────────────────────────────────────────
+
+MainPanel::MainPanel(int height, int width)
+:
+Panel(
+    "vtop", // title
+    6, // color pair
+    height,
+    width,
+    0,
+    0) {}
+
+void MainPanel::drawMain(const std::string &status, const std::string &help){
+    drawPanel();
+
+    // both texts form the bottom row, redrawn together when either changes
+    m_footer.assign(status);
+    m_footer.push_back('\n');
+    m_footer.append(help);
+    if (rowChanged(m_height - 1, m_footer.data(), m_footer.size())){
+        clearBottomBorder();
+        if (!status.empty()){
+            mvwprintw(win, m_height - 1, 2, " %s ", status.c_str());
+        }
+        mvwprintw(win, m_height - 1, m_width - static_cast<int>(help.length()) - 3, " %s ", help.c_str());
+    }
+
+    wnoutrefresh(win);
+}
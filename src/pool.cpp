@@ -0,0 +1,89 @@
+#include <unistd.h>
+
+#include "../include/pool.hpp"
+
+WorkerPool::WorkerPool(size_t threads){
+    for (size_t i = 1; i < threads; ++i){
+        m_threads.emplace_back(&WorkerPool::work, this);
+    }
+}
+
+WorkerPool::~WorkerPool(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start_cv.notify_all();
+
+    for (std::thread &thread : m_threads){
+        thread.join();
+    }
+}
+
+void WorkerPool::run(size_t tasks, const std::function<void(size_t)> &task){
+    if (m_threads.empty()){
+        for (size_t i = 0; i < tasks; ++i){
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_tasks = tasks;
+        m_next.store(0, std::memory_order_relaxed);
+        m_active = m_threads.size();
+        ++m_job;
+    }
+    m_start_cv.notify_all();
+
+    // the caller works too instead of just waiting
+    drain();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done_cv.wait(lock, [this]{ return m_active == 0; });
+    m_task = nullptr;
+}
+
+void WorkerPool::drain(){
+    while (true){
+        size_t i = m_next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= m_tasks){
+            return;
+        }
+        (*m_task)(i);
+    }
+}
+
+void WorkerPool::work(){
+    unsigned long seen_job = 0;
+
+    while (true){
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start_cv.wait(lock, [&]{ return m_stop || m_job != seen_job; });
+            if (m_stop){
+                return;
+            }
+            seen_job = m_job;
+        }
+
+        drain();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_active == 0){
+                m_done_cv.notify_one();
+            }
+        }
+    }
+}
+
+size_t defaultScanWorkers(){
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online < 4){
+        return 1;
+    }
+    return static_cast<size_t>(online / 4);
+}
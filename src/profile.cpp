@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <ctime>
+#include <unistd.h>
+
+#include "../include/profile.hpp"
+#include "../include/reader.hpp"
+
+const char *stageName(Stage stage){
+    switch (stage){
+        case Stage::CpuStat: return "/proc/stat";
+        case Stage::MemInfo: return "/proc/meminfo";
+        case Stage::Pressure: return "/proc/pressure";
+        case Stage::NetDev: return "/proc/net/dev";
+        case Stage::ProcEnum: return "proc enum";
+        case Stage::StatParse: return "stat parse";
+        case Stage::CmdlineRead: return "cmdline read";
+        case Stage::IoRead: return "io read";
+        case Stage::PssRead: return "smaps read";
+        case Stage::Cgroups: return "cgroups";
+        case Stage::Collect: return "snapshot copy";
+        case Stage::Sort: return "sort/filter";
+        case Stage::DrawCpu: return "draw cpu";
+        case Stage::DrawSysInfo: return "draw sysinfo";
+        case Stage::DrawMem: return "draw mem";
+        case Stage::DrawPressure: return "draw pressure";
+        case Stage::DrawProc: return "draw proc";
+        case Stage::DrawMain: return "draw main";
+        case Stage::Doupdate: return "doupdate";
+        default: return "?";
+    }
+}
+
+uint64_t monotonicNs(){
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+// ─────────────────────────────────────────────
+// Profiler
+// ─────────────────────────────────────────────
+
+// bucket 0 is under 1us (1024 ns), every bucket after it twice as wide as the one before
+size_t Profiler::bucket(uint64_t ns){
+    size_t b = 0;
+    for (uint64_t limit = 1024; ns >= limit && b + 1 < BUCKETS; limit <<= 1){
+        ++b;
+    }
+    return b;
+}
+
+void Profiler::record(Stage stage, uint64_t ns){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Ring &ring = m_rings[static_cast<size_t>(stage)];
+
+    // the oldest duration leaves the histogram as the new one comes in
+    if (ring.count == WINDOW){
+        --ring.buckets[bucket(ring.samples[ring.next])];
+    } else {
+        ++ring.count;
+    }
+    ring.samples[ring.next] = ns;
+    ++ring.buckets[bucket(ns)];
+    ring.next = (ring.next + 1) % WINDOW;
+}
+
+void Profiler::summarize(Stage stage, Summary &out) const{
+    uint64_t sorted[WINDOW];
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Ring &ring = m_rings[static_cast<size_t>(stage)];
+
+        out.count = ring.count;
+        out.last = ring.count > 0 ? ring.samples[(ring.next + WINDOW - 1) % WINDOW] : 0;
+        std::copy(ring.buckets, ring.buckets + BUCKETS, out.buckets);
+        std::copy(ring.samples, ring.samples + ring.count, sorted); // order does not matter from here on
+    }
+
+    out.p50 = out.p99 = out.max = 0;
+    if (out.count == 0){
+        return;
+    }
+
+    // only read while the overlay is open, a partial sort of 256 values is nothing
+    uint64_t *end = sorted + out.count;
+    std::nth_element(sorted, sorted + out.count / 2, end);
+    out.p50 = sorted[out.count / 2];
+    std::nth_element(sorted, sorted + out.count * 99 / 100, end);
+    out.p99 = sorted[out.count * 99 / 100];
+    out.max = *std::max_element(sorted, end);
+}
+
+Profiler &profiler(){
+    static Profiler instance;
+    return instance;
+}
+
+// ─────────────────────────────────────────────
+// SelfUsage
+// ─────────────────────────────────────────────
+
+void SelfUsage::update(){
+    ProcStat ps{};
+    if (!readProcStat(liveSource(), "self", ps)){
+        return;
+    }
+
+    static const long ticks_per_second = sysconf(_SC_CLK_TCK);
+    static const long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+
+    unsigned long long ticks = ps.utime + ps.stime;
+    uint64_t now = monotonicNs();
+    if (m_prev_ns > 0 && now > m_prev_ns && ticks_per_second > 0){
+        double seconds = (now - m_prev_ns) / 1e9;
+        m_cpu_percent = (ticks - m_prev_ticks) * 100.0 / (ticks_per_second * seconds);
+    }
+    m_prev_ticks = ticks;
+    m_prev_ns = now;
+
+    m_rss_kb = ps.rss * page_kb;
+    m_threads = ps.threads;
+}
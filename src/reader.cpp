@@ -1,60 +1,28 @@
 #include <cctype>
-#include <fstream>
-#include <iostream>
 #include <string>
 #include <sstream>
 #include <unistd.h>
 #include <vector>
 #include <ctime>
-#include <filesystem>
 #include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 
-struct CPUStat{
-    std::string cpu;
-    unsigned long long busy;
-    unsigned long long idle;
-    double cpu_usage_percent;
-
-    CPUStat(const std::string& c, unsigned long long b, unsigned long long i, double u) : cpu(c), busy(b), idle(i), cpu_usage_percent(u){}
-};
-
-struct MemStat{
-    unsigned long long total_kb;
-    unsigned long long free_kb;
-    unsigned long long available_kb;
-    unsigned long long buffers_kb;
-    unsigned long long cached_kb;
-    unsigned long long used_kb;
-
-    double used_percent;
-};
-
-struct ProcStat{
-    int pid; // process id
-    int ppid; // parent process id
-    std::string process_name; // process name
-    std::string command_name; // full command
-    int threads; // number of threads
-
-    // stats
-    unsigned long utime; // user cpu ticks
-    unsigned long stime; // system cpu ticks
-    unsigned long vsize; // virtual memory (bytes)
-    long rss; // resident pages
-
-    // derived
-    double cpu_percent; // cpu %
-    unsigned long memb_kb; // memb (rss in KB)
-};
+#include "../include/cgroup.hpp"
+#include "../include/net.hpp"
+#include "../include/profile.hpp"
+#include "../include/reader.hpp"
+#include "../include/taskstats.hpp"
 
 // ─────────────────────────────────────────────
 // System related functions
 // ─────────────────────────────────────────────
 
 // get system time
-std::string getOSTime(){
-    std::time_t now = time(NULL);
-    std::tm* tm_info = localtime(&now);
+std::string getOSTime(std::time_t time){
+    std::tm* tm_info = localtime(&time);
     char buffer[32];
     strftime(buffer, sizeof(buffer), "%a %b %d %Y | %H:%M:%S" , tm_info);
     return std::string(buffer);
@@ -62,13 +30,14 @@ std::string getOSTime(){
 
 
 // getting OS release name
-std::string getOSName(){
-    std::ifstream file("/etc/os-release");
-
-    if (!file){
+std::string getOSName(ProcSource &source){
+    std::string contents;
+    if (!source.readOSRelease(contents)){
         return "Unknown OS";
     }
 
+    std::istringstream file(contents);
+
     std::string os_release;
     std::string line;
     const std::string key = "PRETTY_NAME=";
@@ -93,113 +62,284 @@ std::string getOSName(){
 }
 
 
+// ─────────────────────────────────────────────
+// In-place parsing helpers
+// ─────────────────────────────────────────────
+
+// skipping n space-separated fields
+static const char *skipFields(const char *p, const char *end, int n){
+    while (n-- > 0 && p < end){
+        while (p < end && *p == ' ') ++p;
+        while (p < end && *p != ' ') ++p;
+    }
+    return p;
+}
+
+// parsing the next space-separated number into value
+template <typename T>
+static const char *parseField(const char *p, const char *end, T &value){
+    while (p < end && *p == ' ') ++p;
+    std::from_chars_result result = std::from_chars(p, end, value);
+    return result.ptr;
+}
+
+// parsing the next space-separated number into value, nullptr if there is none
+template <typename T>
+static const char *parseNumber(const char *p, const char *end, T &value){
+    while (p < end && *p == ' ') ++p;
+    std::from_chars_result result = std::from_chars(p, end, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+// end of the line starting at p (its '\n', or end)
+static const char *lineEnd(const char *p, const char *end){
+    const char *newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return newline ? newline : end;
+}
+
+
 // ─────────────────────────────────────────────
 // CPU related functions
 // ─────────────────────────────────────────────
 
-// getting idle and busy times
-std::vector<CPUStat> getIdleAndBusyTime(){
-    std::ifstream file("/proc/stat");
+// rows rounded up to whole vectors, so every delta loop runs a multiple of CPU_LANES times
+static size_t paddedRows(size_t rows){
+    return (rows + CPU_LANES - 1) & ~(CPU_LANES - 1);
+}
 
-    if (!file){
-        return {};
+void CpuCounters::clear(){
+    ids.clear();
+    for (std::vector<unsigned long long> &field : ticks){
+        field.clear(); // capacity kept for the next read
     }
+}
 
-    std::string line;
-    const std::string key = "cpu";
+void CpuCounters::push(int id, const unsigned long long (&fields)[CPU_FIELDS]){
+    size_t row = ids.size();
+    ids.push_back(id);
+    for (size_t f = 0; f < CPU_FIELDS; ++f){
+        if (ticks[f].size() <= row){
+            ticks[f].resize(paddedRows(row + 1), 0);
+        }
+        ticks[f][row] = fields[f];
+    }
+}
 
-    std::vector<CPUStat> results;
+unsigned long long CpuCounters::total(size_t row) const{
+    unsigned long long sum = 0;
+    for (size_t f = 0; f < CPU_FIELDS; ++f){
+        if (f != static_cast<size_t>(CpuField::Guest)){
+            sum += ticks[f][row];
+        }
+    }
+    return sum;
+}
 
-    while(std::getline(file, line)){
-        if (line.find(key) == 0){
-            std::istringstream line_iss(line);
-
-            std::string cpu;
-            unsigned long long user_time; // user time
-            unsigned long long nice_time; // nice time
-            unsigned long long system_time; // system time
-            unsigned long long idle_time; // idle time
-            unsigned long long iowait_time; // I/O wait time
-            unsigned long long irq_time; // interrupt servicing time
-            unsigned long long softirq_time; // softirqs servicing time
-            unsigned long long steal_time; // stolen time
-
-            if (!(line_iss >> cpu >> user_time >> nice_time >> system_time >> idle_time >> iowait_time >> irq_time >> softirq_time >> steal_time)){
-                continue;
-            }
+// reading every cpu line of /proc/stat into out, no per-row strings
+bool readCpuCounters(ProcSource &source, CpuCounters &out){
+    out.clear();
 
-            unsigned long long busy = user_time + nice_time + system_time + irq_time + softirq_time + steal_time;
-            unsigned long long  idle = idle_time + iowait_time;
+    // reused across samples, so it stays as large as the previous read
+    static thread_local std::string contents;
+    if (!source.read("stat", contents)){
+        return false;
+    }
 
-            double usage = ((double)busy/(busy+idle))*100;
+    // parsing in place, the "cpu" lines come first
+    const char *p = contents.data();
+    const char *end = p + contents.size();
+    while (p < end){
+        const char *line_end = lineEnd(p, end);
 
-            results.emplace_back(cpu, busy, idle, usage);
+        if (line_end - p < 3 || std::memcmp(p, "cpu", 3) != 0){
+            if (out.rows() > 0){
+                break; // past the cpu lines, the rest (intr, softirq, ...) is not needed
+            }
+            p = line_end + 1;
+            continue;
+        }
+
+        // "cpu" is the aggregate, "cpuN" core N
+        int id = -1;
+        const char *q = p + 3;
+        if (q < line_end && *q != ' '){
+            std::from_chars_result parsed = std::from_chars(q, line_end, id);
+            if (parsed.ec != std::errc()){
+                p = line_end + 1;
+                continue;
+            }
+            q = parsed.ptr;
+        }
+
+        // user, nice, system and idle are always there, older kernels stop before steal or guest
+        unsigned long long fields[CPU_FIELDS] = {};
+        size_t parsed = 0;
+        while (parsed < CPU_FIELDS){
+            const char *next = parseNumber(q, line_end, fields[parsed]);
+            if (!next){
+                break;
+            }
+            q = next;
+            ++parsed;
+        }
 
+        if (parsed > static_cast<size_t>(CpuField::Idle)){
+            out.push(id, fields);
         }
+
+        p = line_end + 1;
     }
 
-    return results;
+    return true;
 }
 
-// calculating delta time
-std::vector<CPUStat> calculateDeltaTime(const std::vector<CPUStat> &prevResults, const std::vector<CPUStat> &currResults){
-    std::vector<CPUStat> deltaTimeResults;
+// the steps of computeCpuUsage, each a branch-free loop over arrays that cannot overlap, run over
+// the padded rows so the trip count is a multiple of CPU_LANES: that is what lets the compiler
+// turn them into vector code even at -O2 (which never adds a scalar tail loop)
+// kept out of line, inlined into the loop over fields they are no longer vectorized
+
+// ticks between two reads, clamped at 0: a counter can go backwards (iowait on NO_HZ kernels,
+// a cpu coming back from hotplug) and would otherwise turn into a negative percent
+__attribute__((noinline)) static void tickDeltas(const unsigned long long *__restrict now, const unsigned long long *__restrict before, int32_t *__restrict delta, size_t rows){
+    size_t n = paddedRows(rows);
+    for (size_t i = 0; i < n; ++i){
+        int32_t d = static_cast<int32_t>(now[i] - before[i]);
+        delta[i] = d & -static_cast<int32_t>(d >= 0);
+    }
+}
 
-    for (size_t i=0; i<prevResults.size() && i<currResults.size(); ++i){
-        std::string cpu = prevResults[i].cpu;
-        unsigned long long deltaBusy = currResults[i].busy - prevResults[i].busy;
-        unsigned long long deltaIdle = currResults[i].idle - prevResults[i].idle;
+__attribute__((noinline)) static void addDeltas(int32_t *__restrict sum, const int32_t *__restrict delta, size_t rows){
+    size_t n = paddedRows(rows);
+    for (size_t i = 0; i < n; ++i){
+        sum[i] += delta[i];
+    }
+}
 
-        double deltaUsage = ((double)deltaBusy/(deltaBusy+deltaIdle))*100;
+// 100 / elapsed (rows that did not tick have no deltas to scale, any scale does for them)
+__attribute__((noinline)) static void percentScale(const int32_t *__restrict elapsed, float *__restrict scale, size_t rows){
+    size_t n = paddedRows(rows);
+    for (size_t i = 0; i < n; ++i){
+        scale[i] = 100.0f / static_cast<float>(elapsed[i] > 1 ? elapsed[i] : 1);
+    }
+}
 
-        deltaTimeResults.emplace_back(cpu, deltaBusy, deltaIdle, deltaUsage);
+__attribute__((noinline)) static void scaleDeltas(const int32_t *__restrict delta, const float *__restrict scale, float *__restrict percent, size_t rows){
+    size_t n = paddedRows(rows);
+    for (size_t i = 0; i < n; ++i){
+        percent[i] = static_cast<float>(delta[i]) * scale[i];
     }
+}
 
-    return deltaTimeResults;
+__attribute__((noinline)) static void addPercent(float *__restrict sum, const float *__restrict percent, size_t rows){
+    size_t n = paddedRows(rows);
+    for (size_t i = 0; i < n; ++i){
+        sum[i] += percent[i];
+    }
 }
 
+__attribute__((noinline)) static void widenTicks(const int32_t *__restrict ticks, unsigned long long *__restrict out, size_t rows){
+    size_t n = paddedRows(rows);
+    for (size_t i = 0; i < n; ++i){
+        out[i] = static_cast<unsigned long long>(ticks[i]);
+    }
+}
+
+void computeCpuUsage(const CpuCounters &prev, const CpuCounters &curr, CpuUsage &out){
+    size_t rows = curr.rows();
+    size_t n = paddedRows(rows);
+
+    out.ids = curr.ids;
+    out.busy.resize(n);
+    out.elapsed.resize(n);
+    for (std::vector<float> &field : out.percent){
+        field.resize(n);
+    }
+
+    // first sample, or a core went on or offline: usage since boot, once, counters too large for 32 bits
+    if (prev.ids != curr.ids){
+        for (size_t i = 0; i < rows; ++i){
+            unsigned long long total = curr.total(i);
+            double scale = total > 0 ? 100.0 / total : 0.0;
+            for (size_t f = 0; f < CPU_FIELDS; ++f){
+                out.percent[f][i] = static_cast<float>(curr.ticks[f][i] * scale);
+            }
+            out.busy[i] = total > 0 ? static_cast<float>((total - curr.field(CpuField::Idle, i) - curr.field(CpuField::Iowait, i)) * scale) : 0.0f;
+            out.elapsed[i] = total;
+        }
+        return;
+    }
+
+    // every other sample: one pass per step over whole fields
+    static thread_local std::vector<int32_t> delta[CPU_FIELDS];
+    static thread_local std::vector<int32_t> elapsed;
+    static thread_local std::vector<float> scale;
+    elapsed.assign(n, 0);
+    scale.resize(n);
+
+    for (size_t f = 0; f < CPU_FIELDS; ++f){
+        delta[f].resize(n);
+        tickDeltas(curr.ticks[f].data(), prev.ticks[f].data(), delta[f].data(), rows);
+        if (f != static_cast<size_t>(CpuField::Guest)){
+            addDeltas(elapsed.data(), delta[f].data(), rows);
+        }
+    }
+
+    percentScale(elapsed.data(), scale.data(), rows);
+    for (size_t f = 0; f < CPU_FIELDS; ++f){
+        scaleDeltas(delta[f].data(), scale.data(), out.percent[f].data(), rows);
+    }
 
-// displaying CPU stat
-void displayCPUStat(const std::vector<CPUStat> &results){
-    for (size_t i=0; i<results.size(); i++){
-        std::cout << "CPU: " << results[i].cpu << "\t\tBusy: " << results[i].busy << "\t\tIdle: " << results[i].idle << "\n";
+    // busy is every field but idle, iowait and guest (which user already counts)
+    std::fill(out.busy.begin(), out.busy.end(), 0.0f);
+    for (CpuField f : {CpuField::User, CpuField::Nice, CpuField::System, CpuField::Irq, CpuField::Softirq, CpuField::Steal}){
+        addPercent(out.busy.data(), out.percent[static_cast<size_t>(f)].data(), rows);
     }
+    widenTicks(elapsed.data(), out.elapsed.data(), rows);
 }
 
 // ─────────────────────────────────────────────
 // Meminfo related functions
 // ─────────────────────────────────────────────
 
-MemStat getMemInfo(){
-    std::ifstream file("/proc/meminfo");
+MemStat getMemInfo(ProcSource &source){
     MemStat mem = {0, 0, 0, 0, 0, 0, 0.0};
 
-    if (!file){
+    // reused across samples, so it stays as large as the previous read
+    static thread_local std::string contents;
+    if (!source.read("meminfo", contents)){
         return mem;
     }
 
-    std::string line;
-    while (std::getline(file, line)){
-        std::istringstream iss(line);
-        std::string key;
-        unsigned long long value;
-
-        if (!(iss >> key >> value)){
-            continue;
-        }
-
-        if (key == "MemTotal:"){
-            mem.total_kb = value;
-        } else if (key == "MemFree:") {
-            mem.free_kb = value;
-        } else if (key == "MemAvailable:"){
-            mem.available_kb = value;
-        } else if (key == "Buffers:"){
-            mem.buffers_kb = value;
-        } else if (key == "Cached:"){
-            mem.cached_kb = value;
+    // "Key:   value kB" lines, parsed in place
+    struct Field{
+        const char *key;
+        size_t key_len;
+        unsigned long long *value;
+    };
+    const Field fields[] = {
+        {"MemTotal:", 9, &mem.total_kb},
+        {"MemFree:", 8, &mem.free_kb},
+        {"MemAvailable:", 13, &mem.available_kb},
+        {"Buffers:", 8, &mem.buffers_kb},
+        {"Cached:", 7, &mem.cached_kb},
+    };
+
+    const char *p = contents.data();
+    const char *end = p + contents.size();
+    size_t found = 0;
+    while (p < end && found < std::size(fields)){
+        const char *line_end = lineEnd(p, end);
+
+        for (const Field &field : fields){
+            if (static_cast<size_t>(line_end - p) > field.key_len && std::memcmp(p, field.key, field.key_len) == 0){
+                if (parseNumber(p + field.key_len, line_end, *field.value)){
+                    ++found;
+                }
+                break;
+            }
         }
 
+        p = line_end + 1;
     }
 
     mem.used_kb = mem.total_kb - mem.available_kb;
@@ -215,127 +355,709 @@ MemStat getMemInfo(){
 }
 
 // ─────────────────────────────────────────────
-// Proc related functions
+// Pressure stall information
 // ─────────────────────────────────────────────
 
-std::vector<std::string> procDirectories;
+// paths of the files, in PressureResource order
+static const char *const PRESSURE_PATHS[] = {"pressure/cpu", "pressure/memory", "pressure/io"};
 
-// listing directories in /proc/
-void listProcDirectories(){
-    procDirectories.clear();
-
-    for (const auto& entry : std::filesystem::directory_iterator("/proc")){
+const char *pressureResourceName(PressureResource resource){
+    switch (resource){
+        case PressureResource::Cpu: return "cpu";
+        case PressureResource::Memory: return "memory";
+        case PressureResource::Io: return "io";
+        default: return "?";
+    }
+}
 
-        // skip if not a directory
-        if (!entry.is_directory()){
-            continue;
+// the "avg10=2.53 avg60=5.11 avg300=3.11 total=128933278" of a line from p, false if a value is missing
+static bool parsePressureLine(const char *p, const char *end, PressureLine &line){
+    struct Field{
+        const char *key;
+        size_t key_len;
+        float *value;
+    };
+    const Field fields[] = {
+        {"avg10=", 6, &line.avg10},
+        {"avg60=", 6, &line.avg60},
+        {"avg300=", 7, &line.avg300},
+    };
+
+    for (const Field &field : fields){
+        while (p < end && *p == ' ') ++p;
+        if (static_cast<size_t>(end - p) <= field.key_len || std::memcmp(p, field.key, field.key_len) != 0){
+            return false;
         }
+        std::from_chars_result result = std::from_chars(p + field.key_len, end, *field.value);
+        if (result.ec != std::errc()){
+            return false;
+        }
+        p = result.ptr;
+    }
 
-        // converting directory name to string
-        std::string dirname = entry.path().filename().string();
+    while (p < end && *p == ' ') ++p;
+    if (end - p <= 6 || std::memcmp(p, "total=", 6) != 0){
+        return false;
+    }
+    return parseNumber(p + 6, end, line.total_us) != nullptr;
+}
+
+bool parsePressure(const char *buf, size_t len, PressureStat &out){
+    out.valid = false;
+    out.has_full = false;
+
+    // a "some" line, then a "full" one on every resource but cpu before 5.13
+    const char *p = buf;
+    const char *end = buf + len;
+    while (p < end){
+        const char *line_end = lineEnd(p, end);
 
-        if (!dirname.empty() && std::all_of(dirname.begin(), dirname.end(), ::isdigit)){
-            procDirectories.push_back(dirname);
+        if (line_end - p > 5 && std::memcmp(p, "some ", 5) == 0){
+            out.valid = parsePressureLine(p + 5, line_end, out.some);
+        } else if (line_end - p > 5 && std::memcmp(p, "full ", 5) == 0){
+            out.has_full = parsePressureLine(p + 5, line_end, out.full);
         }
+
+        p = line_end + 1;
+    }
+    return out.valid;
+}
+
+bool readPressure(ProcSource &source, PressureResource resource, PressureStat &out){
+    // two lines of about 60 characters, read and parsed in place
+    char buf[256];
+    ssize_t len = source.read(PRESSURE_PATHS[static_cast<size_t>(resource)], buf, sizeof(buf));
+    if (len <= 0){
+        out.valid = false;
+        out.has_full = false;
+        return false;
     }
+    return parsePressure(buf, len, out);
 }
 
-int listNumberOfProcDirectories(){
-    listProcDirectories();
-    return procDirectories.size();
+// one line's stall time between two readings
+static void pressureLineDelta(const PressureLine &prev, PressureLine &curr, uint64_t elapsed_ns){
+    curr.delta_us = curr.total_us >= prev.total_us ? curr.total_us - prev.total_us : 0;
+    curr.interval_percent = static_cast<float>(std::min(100.0, 100.0 * curr.delta_us * 1000.0 / elapsed_ns));
+}
+
+void computePressureDelta(const PressureStat &prev, PressureStat &curr, uint64_t elapsed_ns){
+    curr.has_delta = curr.valid && prev.valid && elapsed_ns > 0;
+    if (!curr.has_delta){
+        curr.some.delta_us = curr.full.delta_us = 0;
+        curr.some.interval_percent = curr.full.interval_percent = 0.0f;
+        return;
+    }
+
+    pressureLineDelta(prev.some, curr.some, elapsed_ns);
+    if (curr.has_full && prev.has_full){
+        pressureLineDelta(prev.full, curr.full, elapsed_ns);
+    } else {
+        curr.full.delta_us = 0;
+        curr.full.interval_percent = 0.0f;
+    }
+}
+
+// ─────────────────────────────────────────────
+// Proc related functions
+// ─────────────────────────────────────────────
+
+// page size in KB, asked once instead of for every process
+static long pageSizeKB(){
+    static const long page_size_kb = sysconf(_SC_PAGE_SIZE)/1024;
+    return page_size_kb;
 }
 
-bool readProcStat(const std::string &pid, ProcStat& ps){
-    std::string path = "/proc/" + pid + "/stat";
-    std::ifstream file(path);
+// building "<pid>/<file>" into buf without allocating, returns false if it does not fit
+static bool buildPidPath(char *buf, size_t size, const char *pid, const char *file){
+    size_t pid_len = std::strlen(pid);
+    size_t file_len = std::strlen(file);
 
-    if (!file){
+    if (pid_len + 1 + file_len + 1 > size){
         return false;
     }
 
-    std::string line;
-    std::getline(file, line);
+    std::memcpy(buf, pid, pid_len);
+    buf[pid_len] = '/';
+    std::memcpy(buf + pid_len + 1, file, file_len + 1);
+    return true;
+}
+
+bool parseProcStat(const char *buf, size_t len, ProcStat& ps){
+    const char *begin = buf;
+    const char *end = buf + len;
 
-    // finding parenthesis
-    size_t open = line.find('(');
-    size_t close = line.rfind(')');
+    // finding parenthesis, the name itself may contain ')' so searching the last one
+    const char *open = static_cast<const char*>(std::memchr(begin, '(', len));
+    const char *close = static_cast<const char*>(memrchr(begin, ')', len));
 
-    if (open == std::string::npos || close == std::string::npos){
+    if (!open || !close || close < open || close + 2 >= end){
         return false;
     }
 
     // everything before '(' is pid
-    ps.pid = std::stoi(line.substr(0, open));
+    if (std::from_chars(begin, open, ps.pid).ec != std::errc()){
+        return false;
+    }
 
-    // between parenthesis is the process name
-    ps.process_name = line.substr(open+1, close-open-1);
+    // between parenthesis is the process name (short enough to fit the string's inline buffer)
+    ps.process_name.assign(open + 1, close - open - 1);
 
-    // remaining fields
-    std::istringstream iss(line.substr(close + 2));
+    // remaining fields, starting at the state (field 3)
+    const char *p = close + 2;
 
-    char state;
-    iss >> state; // state
-    iss >> ps.ppid; // parent process id
+    p = skipFields(p, end, 1); // state
+    p = parseField(p, end, ps.ppid); // parent process id (4)
 
-    // skipping unwanted fields
-    unsigned long long skip;
-    iss >> skip >> skip >> skip >> skip >> skip >> skip >> skip >> skip >> skip;
+    // skipping pgrp .. cmajflt (5-13)
+    p = skipFields(p, end, 9);
 
-    // utime and stime
-    iss >> ps.utime >> ps.stime;
+    // utime and stime (14, 15)
+    p = parseField(p, end, ps.utime);
+    p = parseField(p, end, ps.stime);
 
-    // skipping unwanted fields again
-    iss >> skip >> skip >> skip >> skip;
+    // skipping cutime .. nice (16-19)
+    p = skipFields(p, end, 4);
 
-    // thread count
-    iss >> ps.threads;
+    // thread count (20)
+    p = parseField(p, end, ps.threads);
 
-    // skipping unwanted fields yet again;
-    iss >> skip >> skip;
+    // skipping itrealvalue, then start time (to tell reused pids apart) (21, 22)
+    p = skipFields(p, end, 1);
+    p = parseField(p, end, ps.starttime);
 
-    // vsize and rss
-    iss >> ps.vsize >> ps.rss;
+    // vsize and rss (23, 24)
+    p = parseField(p, end, ps.vsize);
+    parseField(p, end, ps.rss);
 
     // convering rss pages to KB
-    long page_size_kb = sysconf(_SC_PAGE_SIZE)/1024;
-    ps.memb_kb = ps.rss + page_size_kb;
+    ps.memb_kb = ps.rss * pageSizeKB();
+
+    return true;
+}
+
+bool readProcStat(ProcSource &source, const char *pid, ProcStat& ps){
+    char path[32];
+    if (!buildPidPath(path, sizeof(path), pid, "stat")){
+        return false;
+    }
+
+    // a stat line is well under 1KB, the name being capped at 16 characters
+    char buf[1024];
+    ssize_t len = source.read(path, buf, sizeof(buf));
+    if (len <= 0){
+        return false;
+    }
+
+    return parseProcStat(buf, len, ps);
+}
+
+bool readCmdLine(ProcSource &source, const char *pid, std::string &cmdline){
+    char path[32];
+    if (!buildPidPath(path, sizeof(path), pid, "cmdline")){
+        return false;
+    }
+
+    // reading into the string's existing capacity, growing only for unusually long commands
+    if (!source.read(path, cmdline)){
+        return false;
+    }
+    size_t total = cmdline.size();
+
+    // dropping the trailing null byte
+    while (total > 0 && cmdline[total - 1] == '\0'){
+        --total;
+    }
+    cmdline.resize(total);
+
+    // replacing arguments separated by null bytes (and any newlines or tabs inside them) with spaces
+    std::replace_if(cmdline.begin(), cmdline.end(), [](char c){
+        return static_cast<unsigned char>(c) < 0x20;
+    }, ' ');
 
     return true;
+}
 
+bool parseProcIo(const char *buf, size_t len, ProcStat &ps){
+    // "key: value" lines, rchar and wchar count page cache hits too so only storage traffic is kept
+    struct Field{
+        const char *key;
+        size_t key_len;
+        unsigned long long *value;
+    };
+    const Field fields[] = {
+        {"syscr:", 6, &ps.syscr},
+        {"syscw:", 6, &ps.syscw},
+        {"read_bytes:", 11, &ps.read_bytes},
+        {"write_bytes:", 12, &ps.write_bytes},
+    };
+
+    const char *p = buf;
+    const char *end = buf + len;
+    size_t found = 0;
+    while (p < end && found < std::size(fields)){
+        const char *line_end = lineEnd(p, end);
+
+        for (const Field &field : fields){
+            if (static_cast<size_t>(line_end - p) > field.key_len && std::memcmp(p, field.key, field.key_len) == 0){
+                if (parseNumber(p + field.key_len, line_end, *field.value)){
+                    ++found;
+                }
+                break;
+            }
+        }
+
+        p = line_end + 1;
+    }
+
+    return found == std::size(fields);
 }
 
-std::string readCmdLine(const std::string &pid){
-    std::ifstream file("/proc/" + pid + "/cmdline");
-    if (!file){
-        return "";
+bool readProcIo(ProcSource &source, const char *pid, ProcStat &ps){
+    char path[32];
+    if (!buildPidPath(path, sizeof(path), pid, "io")){
+        return false;
+    }
+
+    // seven short lines, and only readable for processes we could ptrace
+    char buf[512];
+    ssize_t len = source.read(path, buf, sizeof(buf));
+    if (len <= 0){
+        return false;
     }
 
-    std::string cmdline;
-    std::getline(file, cmdline);
-    if (cmdline.empty()){
-        return "";
+    return parseProcIo(buf, len, ps);
+}
+
+bool parseSmapsRollup(const char *buf, size_t len, ProcStat &ps){
+    // a header line naming the range, then "Key:   value kB" lines summed over every mapping
+    unsigned long long pss = 0, private_clean = 0, private_dirty = 0;
+    struct Field{
+        const char *key;
+        size_t key_len;
+        unsigned long long *value;
+    };
+    const Field fields[] = {
+        {"Pss:", 4, &pss},
+        {"Private_Clean:", 14, &private_clean},
+        {"Private_Dirty:", 14, &private_dirty},
+    };
+
+    const char *p = buf;
+    const char *end = buf + len;
+    size_t found = 0;
+    while (p < end && found < std::size(fields)){
+        const char *line_end = lineEnd(p, end);
+
+        for (const Field &field : fields){
+            if (static_cast<size_t>(line_end - p) > field.key_len && std::memcmp(p, field.key, field.key_len) == 0){
+                if (parseNumber(p + field.key_len, line_end, *field.value)){
+                    ++found;
+                }
+                break;
+            }
+        }
+
+        p = line_end + 1;
     }
 
-    // replacing arguments separated by null bytes with spaces
-    std::replace(cmdline.begin(), cmdline.end(), '\0', ' ');
+    if (found != std::size(fields)){
+        return false;
+    }
 
-    return cmdline;
+    ps.pss_kb = static_cast<unsigned long>(pss);
+    ps.uss_kb = static_cast<unsigned long>(private_clean + private_dirty);
+    return true;
 }
 
+bool readSmapsRollup(ProcSource &source, const char *pid, ProcStat &ps){
+    char path[32];
+    if (!buildPidPath(path, sizeof(path), pid, "smaps_rollup")){
+        return false;
+    }
 
-std::vector<ProcStat> getProcStats(){
-    listProcDirectories();
+    // about twenty lines, a kernel thread's is empty
+    char buf[2048];
+    ssize_t len = source.read(path, buf, sizeof(buf));
+    if (len <= 0){
+        return false;
+    }
+
+    return parseSmapsRollup(buf, len, ps);
+}
 
-    std::vector<ProcStat> procs;
 
-    for (const auto& pid: procDirectories){
-        ProcStat ps{}; // initializing struct
-        if (!readProcStat(pid, ps)){
+// ─────────────────────────────────────────────
+// ProcTable — persistent pid-keyed process table
+// ─────────────────────────────────────────────
+
+const char *procBackendName(ProcBackend backend){
+    return backend == ProcBackend::Taskstats ? "taskstats" : "procfs";
+}
+
+ProcTable::ProcTable(size_t workers, ProcBackend backend, ProcSource &source)
+:
+    m_pool(workers > 0 ? workers : defaultScanWorkers()),
+    m_chunks(m_pool.size()),
+    m_source(source),
+    m_backend(backend)
+{
+    if (m_backend != ProcBackend::Taskstats){
+        return;
+    }
+
+    // netlink only knows about the running system
+    if (&m_source != &liveSource()){
+        m_backend = ProcBackend::Procfs;
+        return;
+    }
+
+    // one socket per scanning thread, so queries never have to be serialized
+    for (ScanChunk &chunk : m_chunks){
+        chunk.taskstats.reset(new TaskstatsClient());
+        if (!chunk.taskstats->open()){
+            // unavailable or unprivileged, staying on /proc
+            for (ScanChunk &c : m_chunks){
+                c.taskstats.reset();
+            }
+            m_backend = ProcBackend::Procfs;
+            return;
+        }
+    }
+}
+
+ProcTable::~ProcTable() = default;
+
+// reading one process's counters through the table's backend
+bool ProcTable::readStats(ScanChunk &chunk, int pid, const char *name, ProcStat &ps){
+    // taskstats only has peak memory, no thread count and a start time in whole seconds (a pid reused
+    // within the second would pass for the same process), so stat is read either way and taskstats adds cpu
+    if (chunk.taskstats){
+        return readProcStat(m_source, name, ps) && chunk.taskstats->read(pid, ps);
+    }
+    return readProcStat(m_source, name, ps);
+}
+
+// reading the pids in m_pids[begin, end), runs on a pool thread
+// known pids are updated in place (each slot belongs to exactly one pid, so workers never share one)
+// and new pids go to the chunk's own buffer, merged by refresh() afterwards
+void ProcTable::scanRange(size_t begin, size_t end, ScanChunk &chunk, double ticks_per_cpu){
+    chunk.fresh_count = 0;
+
+    char name[16];
+    for (size_t i = begin; i < end; ++i){
+        int pid = m_pids[i];
+        *std::to_chars(name, name + sizeof(name) - 1, pid).ptr = '\0';
+
+        auto it = m_index.find(pid); // read-only while workers run
+
+        if (it != m_index.end()){
+            // known pid, overwriting its stats in place
+            size_t slot = it->second;
+            ProcStat &ps = m_procs[slot];
+            unsigned long long prev_start = ps.starttime;
+            unsigned long prev_ticks = ps.utime + ps.stime;
+
+            if (!readStats(chunk, pid, name, ps)){
+                continue; // exited since readdir, evicted below
+            }
+
+            // same pid but a different start time means the pid was reused,
+            // dropping the cached command line so it is read again when shown
+            if (ps.starttime != prev_start){
+                ps.command_name.clear();
+                ps.cmdline_loaded = false;
+                ps.cpu_percent = 0.0;
+                m_io_read[slot] = 0; // the i/o counters are the old process's
+                m_pss_ns[slot] = 0; // and so is the PSS
+                ps.pss_valid = false;
+                m_cgroup_loaded[slot] = 0;
+                ps.cgroup = -1;
+            } else {
+                unsigned long ticks = ps.utime + ps.stime;
+                unsigned long delta = ticks > prev_ticks ? ticks - prev_ticks : 0;
+                ps.cpu_percent = ticks_per_cpu > 0.0 ? 100.0 * delta / ticks_per_cpu : 0.0;
+            }
+
+            m_last_seen[slot] = m_tick;
+            continue;
+        }
+
+        // new pid, reusing the chunk's buffer entries from earlier refreshes
+        if (chunk.fresh_count == chunk.fresh.size()){
+            chunk.fresh.emplace_back();
+        }
+
+        ProcStat &ps = chunk.fresh[chunk.fresh_count];
+        if (!readStats(chunk, pid, name, ps)){
+            continue;
+        }
+
+        // the command line is read later, and only if the row is shown
+        ps.command_name.clear();
+        ps.cmdline_loaded = false;
+        ps.cpu_percent = 0.0; // no previous sample yet
+        ps.io_valid = false;
+        ps.pss_valid = false;
+        ps.cgroup = -1;
+
+        ++chunk.fresh_count;
+    }
+}
+
+void ProcTable::refresh(unsigned long long total_ticks, size_t num_cpus){
+    ++m_tick;
+
+    // ticks one cpu spent since the previous refresh, used to turn per-process deltas into %
+    double ticks_per_cpu = 0.0;
+    if (m_prev_total_ticks > 0 && total_ticks > m_prev_total_ticks && num_cpus > 0){
+        ticks_per_cpu = static_cast<double>(total_ticks - m_prev_total_ticks) / num_cpus;
+    }
+    m_prev_total_ticks = total_ticks;
+
+    {
+        StageTimer timer(Stage::ProcEnum);
+        m_source.listPids(m_pids);
+    }
+
+    StageTimer timer(Stage::StatParse);
+
+    // splitting the pid list into one contiguous range per pool thread
+    size_t chunks = m_chunks.size();
+    size_t per_chunk = (m_pids.size() + chunks - 1) / chunks;
+
+    m_pool.run(chunks, [&](size_t c){
+        size_t begin = std::min(c * per_chunk, m_pids.size());
+        size_t end = std::min(begin + per_chunk, m_pids.size());
+        scanRange(begin, end, m_chunks[c], ticks_per_cpu);
+    });
+
+    // merging new pids, reusing slots freed by earlier evictions if there are any
+    for (ScanChunk &chunk : m_chunks){
+        for (size_t i = 0; i < chunk.fresh_count; ++i){
+            if (m_size == m_procs.size()){
+                m_procs.emplace_back();
+                m_last_seen.push_back(0);
+                m_io_read.push_back(0);
+                m_io_picked.push_back(0);
+                m_pss_ns.push_back(0);
+                m_cgroup_loaded.push_back(0);
+            }
+
+            // swapping keeps both strings' storage alive for the next refresh
+            std::swap(m_procs[m_size], chunk.fresh[i]);
+            m_index[m_procs[m_size].pid] = m_size;
+            m_last_seen[m_size] = m_tick;
+            m_io_read[m_size] = 0;
+            m_pss_ns[m_size] = 0;
+            m_cgroup_loaded[m_size] = 0;
+            ++m_size;
+        }
+    }
+
+    // evicting pids that were not seen in this pass
+    for (size_t slot = 0; slot < m_size;){
+        if (m_last_seen[slot] == m_tick){
+            ++slot;
+            continue;
+        }
+
+        m_index.erase(m_procs[slot].pid);
+
+        // moving the last live entry into the hole, the evicted one stays behind for reuse
+        size_t last = m_size - 1;
+        if (slot != last){
+            std::swap(m_procs[slot], m_procs[last]);
+            std::swap(m_last_seen[slot], m_last_seen[last]);
+            std::swap(m_io_read[slot], m_io_read[last]);
+            std::swap(m_io_picked[slot], m_io_picked[last]);
+            std::swap(m_pss_ns[slot], m_pss_ns[last]);
+            std::swap(m_cgroup_loaded[slot], m_cgroup_loaded[last]);
+            m_index[m_procs[slot].pid] = slot;
+        }
+        --m_size;
+    }
+}
+
+size_t ProcTable::loadCmdlines(const std::vector<int> &pids){
+    size_t loaded = 0;
+    uint64_t start = monotonicNs();
+
+    char name[16];
+    for (int pid : pids){
+        auto it = m_index.find(pid);
+        if (it == m_index.end() || m_procs[it->second].cmdline_loaded){
+            continue; // gone, or cached for this pid and start time
+        }
+
+        *std::to_chars(name, name + sizeof(name) - 1, pid).ptr = '\0';
+
+        // the command line does not change over the life of a process, so it is read once
+        // (a failed read is cached too, the process is most likely gone)
+        readCmdLine(m_source, name, m_procs[it->second].command_name);
+        m_procs[it->second].cmdline_loaded = true;
+        ++loaded;
+    }
+
+    // mostly everything asked for is cached, only the calls that read something are worth a sample
+    if (loaded > 0){
+        profiler().record(Stage::CmdlineRead, monotonicNs() - start);
+    }
+    return loaded;
+}
+
+size_t ProcTable::readIo(const std::vector<int> &pids, uint64_t now_ns){
+    StageTimer timer(Stage::IoRead);
+
+    double seconds = m_io_ns > 0 && now_ns > m_io_ns ? (now_ns - m_io_ns) / 1e9 : 0.0;
+    m_io_ns = now_ns;
+
+    size_t read = 0;
+    char name[16];
+    auto readSlot = [&](size_t slot){
+        if (m_io_picked[slot] == m_tick){
+            return; // picked twice, on screen and busy
+        }
+        m_io_picked[slot] = m_tick;
+
+        ProcStat &ps = m_procs[slot];
+        unsigned long long prev_read = ps.read_bytes, prev_write = ps.write_bytes;
+        unsigned long long prev_syscalls = ps.syscr + ps.syscw;
+
+        *std::to_chars(name, name + sizeof(name) - 1, ps.pid).ptr = '\0';
+        if (!readProcIo(m_source, name, ps)){
+            return; // gone, or not ours to look at
+        }
+        ++read;
+
+        // a rate needs counters from the refresh right before this one
+        bool consecutive = m_io_read[slot] + 1 == m_tick && seconds > 0.0;
+        m_io_read[slot] = m_tick;
+        if (!consecutive){
+            return;
+        }
+
+        unsigned long long syscalls = ps.syscr + ps.syscw;
+        ps.read_rate = ps.read_bytes > prev_read ? (ps.read_bytes - prev_read) / seconds : 0.0;
+        ps.write_rate = ps.write_bytes > prev_write ? (ps.write_bytes - prev_write) / seconds : 0.0;
+        ps.syscall_rate = syscalls > prev_syscalls ? (syscalls - prev_syscalls) / seconds : 0.0;
+        ps.io_valid = true;
+    };
+
+    // whatever was doing i/o keeps being read even after it scrolled off screen or went quiet on cpu,
+    // so sorting by i/o does not lose it; everything else loses last sample's rates
+    m_io_rank.clear();
+    for (size_t slot = 0; slot < m_size; ++slot){
+        ProcStat &ps = m_procs[slot];
+        bool busy = ps.io_valid && (ps.read_rate > 0.0 || ps.write_rate > 0.0);
+        ps.io_valid = false;
+        if (busy){
+            readSlot(slot);
+        }
+        m_io_rank.push_back(slot);
+    }
+
+    // the busiest processes by cpu, where new i/o mostly comes from
+    size_t top = std::min(IO_TOP_PROCS, m_io_rank.size());
+    std::nth_element(m_io_rank.begin(), m_io_rank.begin() + top, m_io_rank.end(), [this](size_t a, size_t b){
+        return m_procs[a].cpu_percent > m_procs[b].cpu_percent;
+    });
+    for (size_t i = 0; i < top; ++i){
+        readSlot(m_io_rank[i]);
+    }
+
+    // and the rows on screen
+    for (int pid : pids){
+        auto it = m_index.find(pid);
+        if (it != m_index.end()){
+            readSlot(it->second);
+        }
+    }
+
+    return read;
+}
+
+size_t ProcTable::readPss(const std::vector<int> &pids, uint64_t now_ns){
+    size_t read = 0;
+    uint64_t start = monotonicNs();
+
+    char name[16];
+    for (int pid : pids){
+        auto it = m_index.find(pid);
+        if (it == m_index.end()){
             continue;
         }
-        ps.command_name = readCmdLine(pid);
-        procs.push_back(ps);
+
+        // readings stay on screen until they are PSS_MAX_AGE_NS old, failed reads too
+        // (the process is gone or not ours to look at, asking again every sample would not help)
+        size_t slot = it->second;
+        if (m_pss_ns[slot] != 0 && now_ns - m_pss_ns[slot] < PSS_MAX_AGE_NS){
+            continue;
+        }
+        m_pss_ns[slot] = now_ns;
+
+        *std::to_chars(name, name + sizeof(name) - 1, pid).ptr = '\0';
+        ProcStat &ps = m_procs[slot];
+        ps.pss_valid = readSmapsRollup(m_source, name, ps);
+        ++read;
+    }
+
+    // most samples find every reading fresh, only the ones that read something are worth timing
+    if (read > 0){
+        profiler().record(Stage::PssRead, monotonicNs() - start);
+    }
+    return read;
+}
+
+size_t ProcTable::loadCgroups(CgroupTable &cgroups){
+    size_t loaded = 0;
+
+    char name[16];
+    for (size_t slot = 0; slot < m_size; ++slot){
+        if (m_cgroup_loaded[slot] >= CGROUP_READS){
+            continue; // settled for this pid and start time
+        }
+
+        // a failed read counts too, the process is most likely gone
+        ProcStat &ps = m_procs[slot];
+        *std::to_chars(name, name + sizeof(name) - 1, ps.pid).ptr = '\0';
+        ps.cgroup = readPidCgroup(m_source, name, cgroups);
+        ++m_cgroup_loaded[slot];
+        ++loaded;
+    }
+
+    return loaded;
+}
+
+void ProcTable::collect(std::vector<ProcStat> &out) const{
+    StageTimer timer(Stage::Collect);
+
+    // assigning over existing elements keeps their string capacity
+    out.assign(m_procs.begin(), m_procs.begin() + m_size);
+}
+
+
+std::vector<ProcStat> getProcStats(){
+    static ProcTable table;
+
+    CpuCounters cpu;
+    if (!readCpuCounters(liveSource(), cpu) || cpu.rows() == 0){
+        table.refresh(0, 0);
+    } else {
+        table.refresh(cpu.total(0), cpu.rows() - 1);
+    }
+
+    // one-shot callers get every command line
+    std::vector<ProcStat> procs;
+    table.collect(procs);
+
+    std::vector<int> pids;
+    pids.reserve(procs.size());
+    for (const ProcStat &ps : procs){
+        pids.push_back(ps.pid);
     }
+    table.loadCmdlines(pids);
+    table.collect(procs);
 
     std::sort(procs.begin(), procs.end(), [](const ProcStat& a, const ProcStat& b){
         return a.memb_kb > b.memb_kb;
@@ -343,3 +1065,113 @@ std::vector<ProcStat> getProcStats(){
 
     return procs;
 }
+
+
+// ─────────────────────────────────────────────
+// SystemReader — produces SystemSnapshots
+// ─────────────────────────────────────────────
+
+SystemReader::SystemReader(size_t scan_workers, ProcBackend backend, ProcSource &source, bool pss)
+    : m_source(source), m_proc_table(scan_workers, backend, source), m_os_name(getOSName(source)), m_pss(pss), m_net(new NetTable()){}
+
+SystemReader::~SystemReader() = default;
+
+void SystemReader::groupCgroups(bool enabled){
+    m_group_cgroups = enabled;
+    if (enabled && !m_cgroups){
+        m_cgroups.reset(new CgroupTable());
+    }
+}
+
+void SystemReader::sample(SystemSnapshot &out, const std::vector<int> &cmdline_pids, const std::vector<int> &shown_pids){
+    // /proc/stat, read once for both the per-core usage and the per-process cpu %
+    {
+        StageTimer timer(Stage::CpuStat);
+        readCpuCounters(m_source, m_curr_cpu);
+        computeCpuUsage(m_prev_cpu, m_curr_cpu, out.cpu); // since boot on the first sample
+    }
+
+    // the aggregate "cpu" row comes first, the per-core rows after it
+    out.num_cpus = m_curr_cpu.rows() == 0 ? 0 : m_curr_cpu.rows() - 1;
+
+    // /proc/meminfo
+    {
+        StageTimer timer(Stage::MemInfo);
+        out.mem = getMemInfo(m_source);
+    }
+
+    // /proc/pressure/*, the stall time since the previous sample besides the kernel's averages
+    {
+        StageTimer timer(Stage::Pressure);
+        uint64_t pressure_ns = m_source.clockNs();
+        for (size_t i = 0; i < PRESSURE_RESOURCES; ++i){
+            readPressure(m_source, static_cast<PressureResource>(i), out.pressure[i]);
+            computePressureDelta(m_prev_pressure[i], out.pressure[i], m_pressure_ns > 0 && pressure_ns > m_pressure_ns ? pressure_ns - m_pressure_ns : 0);
+        }
+        m_prev_pressure = out.pressure;
+        m_pressure_ns = pressure_ns;
+    }
+
+    // /proc/net/dev, every interface's rates over the time since the previous sample
+    {
+        StageTimer timer(Stage::NetDev);
+        m_net->sample(m_source, m_source.clockNs(), out.net);
+    }
+
+    // /proc/<pid>/*, the process count comes from the same scan
+    if (m_curr_cpu.rows() == 0){
+        m_proc_table.refresh(0, 0);
+    } else {
+        m_proc_table.refresh(m_curr_cpu.total(0), out.num_cpus);
+    }
+    uint64_t now_ns = m_source.clockNs();
+    m_proc_table.readIo(shown_pids, now_ns);
+    if (m_pss){
+        m_proc_table.readPss(shown_pids, now_ns);
+    }
+    // only new pids are looked up, after that grouping costs one read per cgroup file
+    if (m_group_cgroups){
+        StageTimer timer(Stage::Cgroups);
+        m_proc_table.loadCgroups(*m_cgroups);
+    }
+
+    m_proc_table.loadCmdlines(cmdline_pids);
+    m_proc_table.collect(out.procs);
+    out.num_procs = out.procs.size();
+    out.backend = m_proc_table.backend();
+
+    if (m_group_cgroups){
+        StageTimer timer(Stage::Cgroups);
+        m_cgroups->aggregate(out.procs, now_ns, out.cgroups);
+    } else {
+        out.cgroups.clear();
+    }
+
+    out.os_name = m_os_name;
+    out.time = m_source.now();
+    out.sample = ++m_samples;
+
+    std::swap(m_prev_cpu, m_curr_cpu);
+}
+
+bool SystemReader::loadCmdlines(const std::vector<int> &cmdline_pids, const SystemSnapshot &latest, SystemSnapshot &out){
+    if (m_proc_table.loadCmdlines(cmdline_pids) == 0){
+        return false;
+    }
+
+    // the table still holds the counters of the latest sample, only command lines changed
+    out.cpu = latest.cpu;
+    out.mem = latest.mem;
+    out.pressure = latest.pressure;
+    out.net = latest.net;
+    m_proc_table.collect(out.procs);
+    out.cgroups = latest.cgroups;
+    out.num_cpus = latest.num_cpus;
+    out.num_procs = latest.num_procs;
+    out.backend = latest.backend;
+    out.os_name = latest.os_name;
+    out.time = latest.time;
+    out.sample = latest.sample;
+
+    return true;
+}
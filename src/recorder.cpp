@@ -0,0 +1,489 @@
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+
+#include "../include/events.hpp"
+#include "../include/recorder.hpp"
+
+static const char RECORD_MAGIC[] = "VTOPREC";
+static const uint8_t RECORD_VERSION = 1;
+static const size_t RECORD_HEADER_SIZE = sizeof(RECORD_MAGIC) - 1 + 1;
+
+// a key frame every this many frames, so a damaged or truncated file stays readable
+static const unsigned KEY_FRAME_INTERVAL = 60;
+
+static const uint8_t FRAME_KEY = 0x01;
+
+// per-process mask bits
+static const uint8_t PROC_PPID = 0x01;
+static const uint8_t PROC_UTIME = 0x02;
+static const uint8_t PROC_STIME = 0x04;
+static const uint8_t PROC_THREADS = 0x08;
+static const uint8_t PROC_VSIZE = 0x10;
+static const uint8_t PROC_RSS = 0x20;
+static const uint8_t PROC_NAME = 0x40;
+static const uint8_t PROC_NEW = 0x80;
+
+// ─────────────────────────────────────────────
+// varint helpers
+// ─────────────────────────────────────────────
+
+static void putVarint(std::string &out, uint64_t value){
+    while (value >= 0x80){
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// zigzag: small negative deltas stay small
+static void putSigned(std::string &out, int64_t value){
+    putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+static void putDelta(std::string &out, uint64_t curr, uint64_t prev){
+    putSigned(out, static_cast<int64_t>(curr - prev));
+}
+
+static bool getVarint(const std::string &data, size_t &pos, uint64_t &value){
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7){
+        if (pos >= data.size()){
+            return false;
+        }
+        uint8_t byte = static_cast<uint8_t>(data[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)){
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool getSigned(const std::string &data, size_t &pos, int64_t &value){
+    uint64_t raw;
+    if (!getVarint(data, pos, raw)){
+        return false;
+    }
+    value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    return true;
+}
+
+// applying a zigzag delta to a field
+template <typename T>
+static bool getDelta(const std::string &data, size_t &pos, T &value){
+    int64_t delta;
+    if (!getSigned(data, pos, delta)){
+        return false;
+    }
+    value = static_cast<T>(static_cast<int64_t>(value) + delta);
+    return true;
+}
+
+// a recording keeps two numbers per cpu row: busy and idle ticks
+static unsigned long long idleTicks(const CpuCounters &cpu, size_t row){
+    return cpu.field(CpuField::Idle, row) + cpu.field(CpuField::Iowait, row);
+}
+
+static unsigned long long busyTicks(const CpuCounters &cpu, size_t row){
+    return cpu.total(row) - idleTicks(cpu, row);
+}
+
+// ─────────────────────────────────────────────
+// RecordEncoder
+// ─────────────────────────────────────────────
+
+void RecordEncoder::encode(const RecordFrame &frame, bool key, std::string &out){
+    key = key || !m_has_prev;
+
+    // the body is only known once every process is in, so it is built first and copied after its length
+    std::string &body = m_body;
+    body.clear();
+    body.push_back(static_cast<char>(key ? FRAME_KEY : 0));
+    putVarint(body, key ? frame.time_ms : frame.time_ms - m_prev.time_ms);
+
+    // cpu rows
+    putVarint(body, frame.cpu.rows());
+    for (size_t i = 0; i < frame.cpu.rows(); ++i){
+        bool has_prev = !key && i < m_prev.cpu.rows();
+        putDelta(body, busyTicks(frame.cpu, i), has_prev ? busyTicks(m_prev.cpu, i) : 0);
+        putDelta(body, idleTicks(frame.cpu, i), has_prev ? idleTicks(m_prev.cpu, i) : 0);
+    }
+
+    // memory
+    const MemStat zero_mem = {0, 0, 0, 0, 0, 0, 0.0};
+    const MemStat &prev_mem = key ? zero_mem : m_prev.mem;
+    putDelta(body, frame.mem.total_kb, prev_mem.total_kb);
+    putDelta(body, frame.mem.free_kb, prev_mem.free_kb);
+    putDelta(body, frame.mem.available_kb, prev_mem.available_kb);
+    putDelta(body, frame.mem.buffers_kb, prev_mem.buffers_kb);
+    putDelta(body, frame.mem.cached_kb, prev_mem.cached_kb);
+
+    // processes, walking both pid-sorted lists side by side
+    putVarint(body, frame.procs.size());
+    size_t j = 0;
+    int prev_pid = 0;
+    for (const ProcStat &p : frame.procs){
+        putVarint(body, static_cast<uint64_t>(p.pid - prev_pid));
+        prev_pid = p.pid;
+
+        while (!key && j < m_prev.procs.size() && m_prev.procs[j].pid < p.pid){
+            ++j;
+        }
+        const ProcStat *old = nullptr;
+        if (!key && j < m_prev.procs.size() && m_prev.procs[j].pid == p.pid && m_prev.procs[j].starttime == p.starttime){
+            old = &m_prev.procs[j];
+        }
+
+        if (!old){
+            body.push_back(static_cast<char>(PROC_NEW));
+            putSigned(body, p.ppid);
+            putVarint(body, p.starttime);
+            putVarint(body, p.utime);
+            putVarint(body, p.stime);
+            putSigned(body, p.threads);
+            putVarint(body, p.vsize);
+            putSigned(body, p.rss);
+            putVarint(body, p.process_name.size());
+            body.append(p.process_name);
+            continue;
+        }
+
+        uint8_t mask = 0;
+        if (p.ppid != old->ppid) mask |= PROC_PPID;
+        if (p.utime != old->utime) mask |= PROC_UTIME;
+        if (p.stime != old->stime) mask |= PROC_STIME;
+        if (p.threads != old->threads) mask |= PROC_THREADS;
+        if (p.vsize != old->vsize) mask |= PROC_VSIZE;
+        if (p.rss != old->rss) mask |= PROC_RSS;
+        if (p.process_name != old->process_name) mask |= PROC_NAME;
+
+        body.push_back(static_cast<char>(mask));
+        if (mask & PROC_PPID) putSigned(body, static_cast<int64_t>(p.ppid) - old->ppid);
+        if (mask & PROC_UTIME) putDelta(body, p.utime, old->utime);
+        if (mask & PROC_STIME) putDelta(body, p.stime, old->stime);
+        if (mask & PROC_THREADS) putSigned(body, static_cast<int64_t>(p.threads) - old->threads);
+        if (mask & PROC_VSIZE) putDelta(body, p.vsize, old->vsize);
+        if (mask & PROC_RSS) putSigned(body, static_cast<int64_t>(p.rss) - old->rss);
+        if (mask & PROC_NAME){
+            putVarint(body, p.process_name.size());
+            body.append(p.process_name);
+        }
+    }
+
+    putVarint(out, body.size());
+    out.append(body);
+
+    m_prev = frame;
+    m_prev.key = key;
+    m_has_prev = true;
+}
+
+// ─────────────────────────────────────────────
+// RecordDecoder
+// ─────────────────────────────────────────────
+
+bool RecordDecoder::decode(const std::string &data, size_t &pos, RecordFrame &frame){
+    uint64_t body_size;
+    if (!getVarint(data, pos, body_size) || body_size > data.size() - pos){
+        return false;
+    }
+    size_t end = pos + body_size;
+
+    uint8_t flags = static_cast<uint8_t>(data[pos++]);
+    frame.key = flags & FRAME_KEY;
+    if (!frame.key && !m_has_prev){
+        return false; // deltas without anything to apply them to
+    }
+
+    uint64_t time;
+    if (!getVarint(data, pos, time)){
+        return false;
+    }
+    frame.time_ms = frame.key ? time : m_prev.time_ms + time;
+
+    // cpu rows
+    uint64_t rows;
+    if (!getVarint(data, pos, rows) || rows > body_size){
+        return false;
+    }
+    // busy ticks come back as user time and idle ticks as idle time, the breakdown is not recorded
+    frame.cpu.clear();
+    for (uint64_t i = 0; i < rows; ++i){
+        bool has_prev = !frame.key && i < m_prev.cpu.rows();
+        unsigned long long busy = has_prev ? busyTicks(m_prev.cpu, i) : 0;
+        unsigned long long idle = has_prev ? idleTicks(m_prev.cpu, i) : 0;
+        if (!getDelta(data, pos, busy) || !getDelta(data, pos, idle)){
+            return false;
+        }
+
+        unsigned long long fields[CPU_FIELDS] = {};
+        fields[static_cast<size_t>(CpuField::User)] = busy;
+        fields[static_cast<size_t>(CpuField::Idle)] = idle;
+        frame.cpu.push(static_cast<int>(i) - 1, fields);
+    }
+
+    // memory
+    frame.mem = frame.key ? MemStat{0, 0, 0, 0, 0, 0, 0.0} : m_prev.mem;
+    if (!getDelta(data, pos, frame.mem.total_kb) || !getDelta(data, pos, frame.mem.free_kb)
+        || !getDelta(data, pos, frame.mem.available_kb) || !getDelta(data, pos, frame.mem.buffers_kb)
+        || !getDelta(data, pos, frame.mem.cached_kb)){
+        return false;
+    }
+    frame.mem.used_kb = frame.mem.total_kb - frame.mem.available_kb;
+    frame.mem.used_percent = frame.mem.total_kb > 0 ? 100.0 * frame.mem.used_kb / frame.mem.total_kb : 0.0;
+
+    // processes
+    uint64_t count;
+    if (!getVarint(data, pos, count) || count > body_size){
+        return false;
+    }
+    frame.procs.resize(count);
+
+    static const long page_size_kb = sysconf(_SC_PAGE_SIZE)/1024;
+    size_t j = 0;
+    int pid = 0;
+    for (ProcStat &p : frame.procs){
+        uint64_t pid_delta;
+        if (!getVarint(data, pos, pid_delta) || pos >= end){
+            return false;
+        }
+        pid += static_cast<int>(pid_delta);
+        uint8_t mask = static_cast<uint8_t>(data[pos++]);
+
+        if (mask & PROC_NEW){
+            p = ProcStat{};
+            p.pid = pid;
+            uint64_t name_size, starttime, utime, stime, vsize;
+            if (!getDelta(data, pos, p.ppid) || !getVarint(data, pos, starttime)){
+                return false;
+            }
+            p.starttime = starttime;
+            if (!getVarint(data, pos, utime) || !getVarint(data, pos, stime) || !getDelta(data, pos, p.threads)
+                || !getVarint(data, pos, vsize) || !getDelta(data, pos, p.rss)
+                || !getVarint(data, pos, name_size) || name_size > end - pos){
+                return false;
+            }
+            p.utime = utime;
+            p.stime = stime;
+            p.vsize = vsize;
+            p.process_name.assign(data, pos, name_size);
+            pos += name_size;
+        } else {
+            while (j < m_prev.procs.size() && m_prev.procs[j].pid < pid){
+                ++j;
+            }
+            if (frame.key || j >= m_prev.procs.size() || m_prev.procs[j].pid != pid){
+                return false;
+            }
+            p = m_prev.procs[j];
+            if ((mask & PROC_PPID) && !getDelta(data, pos, p.ppid)) return false;
+            if ((mask & PROC_UTIME) && !getDelta(data, pos, p.utime)) return false;
+            if ((mask & PROC_STIME) && !getDelta(data, pos, p.stime)) return false;
+            if ((mask & PROC_THREADS) && !getDelta(data, pos, p.threads)) return false;
+            if ((mask & PROC_VSIZE) && !getDelta(data, pos, p.vsize)) return false;
+            if ((mask & PROC_RSS) && !getDelta(data, pos, p.rss)) return false;
+            if (mask & PROC_NAME){
+                uint64_t name_size;
+                if (!getVarint(data, pos, name_size) || name_size > end - pos){
+                    return false;
+                }
+                p.process_name.assign(data, pos, name_size);
+                pos += name_size;
+            }
+        }
+
+        p.memb_kb = p.rss * page_size_kb;
+    }
+
+    if (pos != end){
+        return false;
+    }
+
+    m_prev = frame;
+    m_has_prev = true;
+    return true;
+}
+
+// ─────────────────────────────────────────────
+// Headless recording
+// ─────────────────────────────────────────────
+
+static uint64_t nowMs(){
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int runRecorder(const std::string &path, std::chrono::milliseconds interval, const Options &options){
+    FILE *file = std::fopen(path.c_str(), "ab");
+    if (!file){
+        std::perror(path.c_str());
+        return 1;
+    }
+
+    // new file: writing the header, existing file: appending after a matching header
+    std::fseek(file, 0, SEEK_END);
+    if (std::ftell(file) == 0){
+        std::fwrite(RECORD_MAGIC, 1, sizeof(RECORD_MAGIC) - 1, file);
+        std::fputc(RECORD_VERSION, file);
+    } else {
+        FILE *check = std::fopen(path.c_str(), "rb");
+        char header[RECORD_HEADER_SIZE] = {};
+        bool valid = check && std::fread(header, 1, sizeof(header), check) == sizeof(header)
+            && std::memcmp(header, RECORD_MAGIC, sizeof(RECORD_MAGIC) - 1) == 0 && header[sizeof(header) - 1] == RECORD_VERSION;
+        if (check){
+            std::fclose(check);
+        }
+        if (!valid){
+            std::fprintf(stderr, "%s: not a vtop recording, refusing to append\n", path.c_str());
+            std::fclose(file);
+            return 1;
+        }
+    }
+
+    // SIGINT and SIGTERM end the recording through a signalfd, blocked before the table's pool threads start
+    SignalWatch signals({SIGINT, SIGTERM});
+    IntervalTimer timer;
+    if (!timer.start(interval)){
+        std::perror("timerfd");
+        std::fclose(file);
+        return 1;
+    }
+
+    ProcTable table(options.scan_workers, options.proc_backend);
+    RecordEncoder encoder;
+    RecordFrame frame;
+    std::string out;
+    unsigned frames = 0;
+    size_t bytes = 0;
+
+    while (true){
+        frame.time_ms = nowMs();
+        readCpuCounters(liveSource(), frame.cpu);
+        frame.mem = getMemInfo();
+
+        if (frame.cpu.rows() == 0){
+            table.refresh(0, 0);
+        } else {
+            table.refresh(frame.cpu.total(0), frame.cpu.rows() - 1);
+        }
+        table.collect(frame.procs);
+        std::sort(frame.procs.begin(), frame.procs.end(), [](const ProcStat &a, const ProcStat &b){
+            return a.pid < b.pid;
+        });
+
+        // the first frame of every run is a key frame, appended files included
+        out.clear();
+        encoder.encode(frame, frames % KEY_FRAME_INTERVAL == 0, out);
+        if (std::fwrite(out.data(), 1, out.size(), file) != out.size() || std::fflush(file) != 0){
+            std::perror(path.c_str());
+            std::fclose(file);
+            return 1;
+        }
+        ++frames;
+        bytes += out.size();
+
+        // the timer keeps the cadence (ticks missed while sampling are dropped), a signal ends the wait
+        int tick = waitForTick(timer, signals);
+        if (tick < 0){
+            std::perror("poll");
+        }
+        if (tick <= 0){
+            break;
+        }
+    }
+
+    std::fclose(file);
+    std::fprintf(stderr, "recorded %u frames, %zu bytes (%.1f bytes/frame) to %s\n", frames, bytes, frames ? static_cast<double>(bytes) / frames : 0.0, path.c_str());
+    return 0;
+}
+
+// ─────────────────────────────────────────────
+// Dumping a recording
+// ─────────────────────────────────────────────
+
+int dumpRecording(const std::string &path){
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file){
+        std::perror(path.c_str());
+        return 1;
+    }
+
+    std::string data;
+    char chunk[65536];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0){
+        data.append(chunk, n);
+    }
+    std::fclose(file);
+
+    if (data.size() < RECORD_HEADER_SIZE || data.compare(0, sizeof(RECORD_MAGIC) - 1, RECORD_MAGIC) != 0){
+        std::fprintf(stderr, "%s: not a vtop recording\n", path.c_str());
+        return 1;
+    }
+    if (static_cast<uint8_t>(data[RECORD_HEADER_SIZE - 1]) != RECORD_VERSION){
+        std::fprintf(stderr, "%s: unsupported recording version %d\n", path.c_str(), data[RECORD_HEADER_SIZE - 1]);
+        return 1;
+    }
+
+    RecordDecoder decoder;
+    RecordFrame frame, prev;
+    bool has_prev = false;
+    size_t pos = RECORD_HEADER_SIZE;
+    unsigned index = 0;
+
+    while (pos < data.size()){
+        if (!decoder.decode(data, pos, frame)){
+            std::fprintf(stderr, "%s: corrupt or truncated frame at byte %zu\n", path.c_str(), pos);
+            return 1;
+        }
+
+        // utilization between this frame and the previous one, nothing to compare the first against
+        double cpu_usage = 0.0;
+        unsigned long long total_delta = 0;
+        if (has_prev && frame.cpu.rows() > 0 && prev.cpu.rows() > 0){
+            unsigned long long busy_delta = busyTicks(frame.cpu, 0) - busyTicks(prev.cpu, 0);
+            total_delta = frame.cpu.total(0) - prev.cpu.total(0);
+            cpu_usage = total_delta > 0 ? 100.0 * busy_delta / total_delta : 0.0;
+        }
+
+        // busiest process since the previous frame
+        const ProcStat *top = nullptr;
+        unsigned long top_ticks = 0;
+        size_t j = 0;
+        for (const ProcStat &p : frame.procs){
+            while (j < prev.procs.size() && prev.procs[j].pid < p.pid){
+                ++j;
+            }
+            if (!has_prev || j >= prev.procs.size() || prev.procs[j].pid != p.pid || prev.procs[j].starttime != p.starttime){
+                continue;
+            }
+            unsigned long ticks = (p.utime + p.stime) - (prev.procs[j].utime + prev.procs[j].stime);
+            if (!top || ticks > top_ticks){
+                top = &p;
+                top_ticks = ticks;
+            }
+        }
+
+        std::time_t seconds = static_cast<std::time_t>(frame.time_ms / 1000);
+        char when[32];
+        std::strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", std::localtime(&seconds));
+
+        std::printf("%6u %s %s cpu %6.2f%% mem %8.1fM/%.1fM procs %5zu", index, when, frame.key ? "key" : "   ",
+            cpu_usage, frame.mem.used_kb / 1024.0, frame.mem.total_kb / 1024.0, frame.procs.size());
+        if (top && total_delta > 0 && frame.cpu.rows() > 1){
+            double per_cpu = static_cast<double>(total_delta) / (frame.cpu.rows() - 1);
+            std::printf(" top %d %s %.1f%%", top->pid, top->process_name.c_str(), 100.0 * top_ticks / per_cpu);
+        }
+        std::printf("\n");
+
+        std::swap(prev.cpu, frame.cpu);
+        prev.procs.swap(frame.procs);
+        has_prev = true;
+        ++index;
+    }
+
+    return 0;
+}
@@ -0,0 +1,658 @@
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <initializer_list>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+#include "../include/events.hpp"
+#include "../include/replay.hpp"
+
+static const char CAPTURE_MAGIC[] = "VTOPCAP";
+static const uint8_t CAPTURE_VERSION = 1;
+static const size_t CAPTURE_HEADER_SIZE = sizeof(CAPTURE_MAGIC) - 1 + 1;
+static const char INDEX_MAGIC[8] = {'V', 'T', 'O', 'P', 'I', 'D', 'X', '\0'};
+static const uint32_t INDEX_MARKER = 0xffffffff;
+
+// a key frame every this many frames, the most frames a seek has to decode
+static const unsigned CAPTURE_KEY_INTERVAL = 60;
+
+static const uint8_t FRAME_KEY = 0x01;
+static const uint8_t FILE_DATA = 0;
+static const uint8_t FILE_SAME = 1;
+
+static const char OS_RELEASE_PATH[] = "os-release";
+
+// fastest fast-forward, speeds double up to it
+static const unsigned MAX_REPLAY_SPEED = 64;
+
+// ─────────────────────────────────────────────
+// Fixed-width fields
+// ─────────────────────────────────────────────
+
+template <typename T>
+static void put(std::string &out, T value){
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// reading a T at data[pos] if it lies before end, advancing pos
+template <typename T>
+static bool get(const char *data, uint64_t end, uint64_t &pos, T &value){
+    if (pos + sizeof(T) > end){
+        return false;
+    }
+    std::memcpy(&value, data + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+// ─────────────────────────────────────────────
+// Headless capture
+// ─────────────────────────────────────────────
+
+// one frame being built, files are kept to tell unchanged ones in the next frame
+struct CaptureFrame{
+    std::string body;
+    uint32_t count = 0;
+    std::unordered_map<std::string, std::string> files; // path -> contents
+    std::unordered_map<int, unsigned long long> starts; // pid -> start time, to spot reused pids
+};
+
+// adding a file to frame, as FILE_SAME when prev held the same contents
+static void addFile(CaptureFrame &frame, const CaptureFrame &prev, bool key, const std::string &path, std::string &contents){
+    auto it = prev.files.find(path);
+    bool same = !key && it != prev.files.end() && it->second == contents;
+
+    frame.body.push_back(static_cast<char>(same ? FILE_SAME : FILE_DATA));
+    put<uint16_t>(frame.body, static_cast<uint16_t>(path.size()));
+    frame.body.append(path);
+    if (!same){
+        put<uint32_t>(frame.body, static_cast<uint32_t>(contents.size()));
+        frame.body.append(contents);
+    }
+    ++frame.count;
+
+    frame.files[path].swap(contents);
+}
+
+int runCapture(const std::string &path, std::chrono::milliseconds interval){
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file){
+        std::perror(path.c_str());
+        return 1;
+    }
+
+    std::fwrite(CAPTURE_MAGIC, 1, sizeof(CAPTURE_MAGIC) - 1, file);
+    std::fputc(CAPTURE_VERSION, file);
+
+    // SIGINT and SIGTERM end the capture through a signalfd
+    SignalWatch signals({SIGINT, SIGTERM});
+    IntervalTimer timer;
+    if (!timer.start(interval)){
+        std::perror("timerfd");
+        std::fclose(file);
+        return 1;
+    }
+
+    ProcSource &source = liveSource();
+    CaptureFrame frame, prev;
+    std::string contents;
+    std::vector<int> pids;
+    std::vector<std::pair<uint32_t, uint64_t>> keys; // frame number, offset
+    uint64_t offset = CAPTURE_HEADER_SIZE;
+    uint32_t frames = 0;
+    char pid_path[32];
+
+    while (true){
+        bool key = frames % CAPTURE_KEY_INTERVAL == 0;
+
+        frame.body.clear();
+        frame.count = 0;
+        frame.files.clear();
+        frame.starts.clear();
+
+        uint64_t time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        put<uint64_t>(frame.body, time_ms);
+        frame.body.push_back(static_cast<char>(key ? FRAME_KEY : 0));
+        size_t count_pos = frame.body.size();
+        put<uint32_t>(frame.body, 0);
+
+        // system-wide files
+        if (source.read("stat", contents)){
+            addFile(frame, prev, key, "stat", contents);
+        }
+        if (source.read("meminfo", contents)){
+            addFile(frame, prev, key, "meminfo", contents);
+        }
+        for (const char *path : {"pressure/cpu", "pressure/memory", "pressure/io", "net/dev"}){
+            if (source.read(path, contents)){
+                addFile(frame, prev, key, path, contents);
+            }
+        }
+        if (source.readOSRelease(contents)){
+            addFile(frame, prev, key, OS_RELEASE_PATH, contents);
+        }
+
+        // per-process files, the command line only when the process is new
+        source.listPids(pids);
+        std::sort(pids.begin(), pids.end());
+        for (int pid : pids){
+            char *end = std::to_chars(pid_path, pid_path + 16, pid).ptr;
+            std::strcpy(end, "/stat");
+            if (!source.read(pid_path, contents)){
+                continue; // exited since listing
+            }
+
+            ProcStat ps{};
+            if (!parseProcStat(contents.data(), contents.size(), ps)){
+                continue;
+            }
+            frame.starts[pid] = ps.starttime;
+            addFile(frame, prev, key, pid_path, contents);
+
+            std::strcpy(end, "/cmdline");
+            auto known = prev.starts.find(pid);
+            auto cmdline = prev.files.find(pid_path);
+            if (!key && known != prev.starts.end() && known->second == ps.starttime && cmdline != prev.files.end()){
+                contents = cmdline->second;
+            } else if (!source.read(pid_path, contents)){
+                contents.clear();
+            }
+            addFile(frame, prev, key, pid_path, contents);
+
+            // left out when the process is not ours to look at, replays then show no i/o for it
+            std::strcpy(end, "/io");
+            if (source.read(pid_path, contents)){
+                addFile(frame, prev, key, pid_path, contents);
+            }
+        }
+
+        std::memcpy(&frame.body[count_pos], &frame.count, sizeof(frame.count));
+
+        if (key){
+            keys.emplace_back(frames, offset);
+        }
+
+        uint32_t size = static_cast<uint32_t>(frame.body.size());
+        if (std::fwrite(&size, sizeof(size), 1, file) != 1
+            || std::fwrite(frame.body.data(), 1, frame.body.size(), file) != frame.body.size()
+            || std::fflush(file) != 0){
+            std::perror(path.c_str());
+            std::fclose(file);
+            return 1;
+        }
+        offset += sizeof(size) + size;
+        ++frames;
+
+        std::swap(frame, prev);
+
+        // the timer keeps the cadence (ticks missed while reading are dropped), a signal ends the wait
+        int tick = waitForTick(timer, signals);
+        if (tick < 0){
+            std::perror("poll");
+        }
+        if (tick <= 0){
+            break;
+        }
+    }
+
+    // key frame index, so opening the archive does not have to walk every frame
+    std::string index;
+    put<uint32_t>(index, INDEX_MARKER);
+    put<uint32_t>(index, frames);
+    put<uint32_t>(index, static_cast<uint32_t>(keys.size()));
+    for (const auto &k : keys){
+        put<uint32_t>(index, k.first);
+        put<uint64_t>(index, k.second);
+    }
+    put<uint64_t>(index, offset);
+    index.append(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+
+    bool written = std::fwrite(index.data(), 1, index.size(), file) == index.size();
+    if (std::fclose(file) != 0 || !written){
+        std::perror(path.c_str());
+        return 1;
+    }
+
+    std::fprintf(stderr, "captured %u frames, %llu bytes (%.1f KB/frame) to %s\n", frames, static_cast<unsigned long long>(offset + index.size()),
+        frames ? static_cast<double>(offset) / frames / 1024.0 : 0.0, path.c_str());
+    return 0;
+}
+
+// ─────────────────────────────────────────────
+// ReplaySource
+// ─────────────────────────────────────────────
+
+ReplaySource::~ReplaySource(){
+    if (m_data){
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+}
+
+bool ReplaySource::open(const std::string &path, std::string &error){
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0){
+        error = std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(CAPTURE_HEADER_SIZE)){
+        close(fd);
+        error = "not a vtop capture";
+        return false;
+    }
+
+    // the mapping outlives the descriptor
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED){
+        error = std::strerror(errno);
+        return false;
+    }
+    m_data = static_cast<const char*>(data);
+    m_size = st.st_size;
+
+    if (std::memcmp(m_data, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC) - 1) != 0){
+        error = "not a vtop capture";
+        return false;
+    }
+    if (static_cast<uint8_t>(m_data[CAPTURE_HEADER_SIZE - 1]) != CAPTURE_VERSION){
+        error = "unsupported capture version";
+        return false;
+    }
+
+    // an interrupted capture has no index, walking the frames instead
+    if (!readIndex() && !scanFrames()){
+        error = "corrupt capture";
+        return false;
+    }
+    if (m_frame_count == 0 || m_keys.empty() || m_keys.front().frame != 0){
+        error = "capture holds no frames";
+        return false;
+    }
+
+    return true;
+}
+
+bool ReplaySource::readIndex(){
+    m_keys.clear();
+
+    size_t trailer = sizeof(uint64_t) + sizeof(INDEX_MAGIC);
+    if (m_size < CAPTURE_HEADER_SIZE + trailer || std::memcmp(m_data + m_size - sizeof(INDEX_MAGIC), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0){
+        return false;
+    }
+
+    uint64_t pos = m_size - trailer;
+    uint64_t index_offset;
+    get(m_data, m_size, pos, index_offset);
+    if (index_offset < CAPTURE_HEADER_SIZE || index_offset >= m_size - trailer){
+        return false;
+    }
+
+    pos = index_offset;
+    uint32_t marker, frames, keys;
+    if (!get(m_data, m_size, pos, marker) || marker != INDEX_MARKER || !get(m_data, m_size, pos, frames) || !get(m_data, m_size, pos, keys)){
+        return false;
+    }
+
+    for (uint32_t i = 0; i < keys; ++i){
+        KeyFrame key;
+        if (!get(m_data, m_size, pos, key.frame) || !get(m_data, m_size, pos, key.offset) || key.offset >= index_offset || key.frame >= frames){
+            m_keys.clear();
+            return false;
+        }
+        m_keys.push_back(key);
+    }
+
+    m_frame_count = frames;
+    m_frames_end = index_offset;
+    return true;
+}
+
+bool ReplaySource::scanFrames(){
+    m_keys.clear();
+    m_frame_count = 0;
+
+    uint64_t pos = CAPTURE_HEADER_SIZE;
+    while (true){
+        uint64_t start = pos;
+        uint32_t size;
+        if (!get(m_data, m_size, pos, size) || size == INDEX_MARKER || pos + size > m_size){
+            m_frames_end = start; // a frame cut short by the capture being killed is dropped
+            break;
+        }
+
+        uint64_t flags_pos = pos + sizeof(uint64_t);
+        if (flags_pos < pos + size && (m_data[flags_pos] & FRAME_KEY)){
+            m_keys.push_back({static_cast<uint32_t>(m_frame_count), start});
+        }
+
+        pos += size;
+        ++m_frame_count;
+    }
+
+    return true;
+}
+
+bool ReplaySource::decodeFrame(uint64_t &offset){
+    uint64_t pos = offset;
+    uint32_t size;
+    if (!get(m_data, m_frames_end, pos, size) || pos + size > m_frames_end){
+        return false;
+    }
+    uint64_t end = pos + size;
+
+    uint8_t flags;
+    uint32_t count;
+    if (!get(m_data, end, pos, m_time_ms) || !get(m_data, end, pos, flags) || !get(m_data, end, pos, count)){
+        return false;
+    }
+
+    // the current files become the previous ones, FILE_SAME entries point at them
+    std::swap(m_files, m_prev_files);
+    m_files.clear();
+
+    for (uint32_t i = 0; i < count; ++i){
+        uint8_t kind;
+        uint16_t path_size;
+        if (!get(m_data, end, pos, kind) || !get(m_data, end, pos, path_size) || pos + path_size > end){
+            return false;
+        }
+
+        File file;
+        file.path = std::string_view(m_data + pos, path_size);
+        pos += path_size;
+
+        if (kind == FILE_DATA){
+            uint32_t data_size;
+            if (!get(m_data, end, pos, data_size) || pos + data_size > end){
+                return false;
+            }
+            file.data = std::string_view(m_data + pos, data_size);
+            pos += data_size;
+        } else {
+            const File *prev = (flags & FRAME_KEY) ? nullptr : find(m_prev_files, file.path);
+            if (!prev){
+                return false;
+            }
+            file.data = prev->data;
+        }
+
+        m_files.push_back(file);
+    }
+
+    std::sort(m_files.begin(), m_files.end(), [](const File &a, const File &b){
+        return a.path < b.path;
+    });
+
+    offset = end;
+    return true;
+}
+
+const ReplaySource::File *ReplaySource::find(const std::vector<File> &files, std::string_view path){
+    auto it = std::lower_bound(files.begin(), files.end(), path, [](const File &file, std::string_view p){
+        return file.path < p;
+    });
+    return it != files.end() && it->path == path ? &*it : nullptr;
+}
+
+bool ReplaySource::load(size_t frame){
+    if (frame >= m_frame_count){
+        return false;
+    }
+
+    // playing forward decodes a single frame
+    if (m_loaded && frame == m_frame + 1){
+        if (!decodeFrame(m_next_offset)){
+            m_loaded = false;
+            return false;
+        }
+        m_frame = frame;
+        return true;
+    }
+
+    // otherwise starting over from the nearest key frame at or before it
+    auto key = std::upper_bound(m_keys.begin(), m_keys.end(), frame, [](size_t f, const KeyFrame &k){
+        return f < k.frame;
+    });
+    --key; // the first key frame is frame 0
+
+    m_loaded = false;
+    m_files.clear();
+    uint64_t offset = key->offset;
+    for (size_t f = key->frame; f <= frame; ++f){
+        if (!decodeFrame(offset)){
+            return false;
+        }
+    }
+
+    m_frame = frame;
+    m_next_offset = offset;
+    m_loaded = true;
+    return true;
+}
+
+uint64_t ReplaySource::nextFrameTimeMs() const{
+    if (!m_loaded || m_frame + 1 >= m_frame_count){
+        return 0;
+    }
+
+    uint64_t pos = m_next_offset + sizeof(uint32_t);
+    uint64_t time_ms = 0;
+    get(m_data, m_frames_end, pos, time_ms);
+    return time_ms;
+}
+
+ssize_t ReplaySource::read(const char *path, char *buf, size_t size){
+    const File *file = find(m_files, path);
+    if (!file){
+        return -1;
+    }
+
+    size_t n = std::min(size, file->data.size());
+    std::memcpy(buf, file->data.data(), n);
+    return static_cast<ssize_t>(n);
+}
+
+bool ReplaySource::read(const char *path, std::string &out){
+    const File *file = find(m_files, path);
+    if (!file){
+        out.clear();
+        return false;
+    }
+
+    out.assign(file->data.data(), file->data.size());
+    return true;
+}
+
+void ReplaySource::listPids(std::vector<int> &pids){
+    pids.clear();
+
+    // every process has a "<pid>/stat" entry
+    static const std::string_view suffix = "/stat";
+    for (const File &file : m_files){
+        std::string_view path = file.path;
+        if (path.size() <= suffix.size() || path.substr(path.size() - suffix.size()) != suffix){
+            continue;
+        }
+
+        const char *name_end = path.data() + path.size() - suffix.size();
+        int pid = 0;
+        std::from_chars_result parsed = std::from_chars(path.data(), name_end, pid);
+        if (parsed.ec == std::errc() && parsed.ptr == name_end){
+            pids.push_back(pid);
+        }
+    }
+}
+
+bool ReplaySource::readOSRelease(std::string &out){
+    return read(OS_RELEASE_PATH, out);
+}
+
+std::time_t ReplaySource::now(){
+    return static_cast<std::time_t>(m_time_ms / 1000);
+}
+
+uint64_t ReplaySource::clockNs(){
+    return m_time_ms * 1000000;
+}
+
+// ─────────────────────────────────────────────
+// Replayer
+// ─────────────────────────────────────────────
+
+bool Replayer::open(const std::string &path, std::string &error){
+    if (!m_source.open(path, error)){
+        return false;
+    }
+    if (!show(0)){
+        error = "corrupt capture";
+        return false;
+    }
+
+    m_due = std::chrono::steady_clock::now();
+    schedule();
+    return true;
+}
+
+// sampling frame into a new snapshot
+// a jump replays the frame before it first, cpu usage is a difference of two samples
+bool Replayer::show(size_t frame){
+    bool sequential = m_reader && m_latest && frame == m_source.frame() + 1;
+
+    if (!sequential){
+        size_t first = frame > 0 ? frame - 1 : frame;
+        if (!m_source.load(first)){
+            return false;
+        }
+
+        // one scan thread, the source is only ever read from this one
+        m_reader.reset(new SystemReader(1, ProcBackend::Procfs, m_source));
+        if (first != frame){
+            SystemSnapshot previous;
+            m_reader->sample(previous, {}, m_shown_pids);
+        }
+    }
+
+    if (!m_source.load(frame)){
+        m_reader.reset();
+        return false;
+    }
+
+    std::shared_ptr<SystemSnapshot> snapshot = std::make_shared<SystemSnapshot>();
+    m_reader->sample(*snapshot, m_cmdline_pids, m_shown_pids);
+    snapshot->generation = ++m_generation;
+    m_latest = std::move(snapshot);
+    return true;
+}
+
+// timing the next frame after the recorded gap, divided by the speed
+void Replayer::schedule(){
+    uint64_t next_ms = m_source.nextFrameTimeMs();
+    uint64_t gap_ms = next_ms > m_source.frameTimeMs() ? next_ms - m_source.frameTimeMs() : 0;
+
+    m_due += std::chrono::milliseconds(gap_ms / m_speed);
+
+    // never catching up in a burst after falling behind
+    auto now = std::chrono::steady_clock::now();
+    if (m_due < now){
+        m_due = now;
+    }
+}
+
+void Replayer::requestCmdlines(const std::vector<int> &pids){
+    m_cmdline_pids = pids;
+
+    std::shared_ptr<SystemSnapshot> snapshot = std::make_shared<SystemSnapshot>();
+    if (m_reader && m_latest && m_reader->loadCmdlines(pids, *m_latest, *snapshot)){
+        snapshot->generation = ++m_generation;
+        m_latest = std::move(snapshot);
+    }
+}
+
+void Replayer::requestShown(const std::vector<int> &pids){
+    m_shown_pids = pids;
+}
+
+bool Replayer::update(){
+    if (m_paused || std::chrono::steady_clock::now() < m_due){
+        return false;
+    }
+
+    // stopping on the last frame
+    if (m_source.frame() + 1 >= m_source.frames() || !show(m_source.frame() + 1)){
+        m_paused = true;
+        return true;
+    }
+
+    schedule();
+    return true;
+}
+
+int Replayer::msUntilDue() const{
+    if (m_paused){
+        return -1;
+    }
+
+    // rounding up, waking a little early would only find the frame not due yet
+    auto left = m_due - std::chrono::steady_clock::now();
+    if (left <= std::chrono::steady_clock::duration::zero()){
+        return 0;
+    }
+    return static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(left).count());
+}
+
+void Replayer::togglePause(){
+    m_paused = !m_paused;
+    if (m_paused){
+        return;
+    }
+
+    // playing again from the start once the end was reached
+    if (m_source.frame() + 1 >= m_source.frames()){
+        show(0);
+    }
+    m_due = std::chrono::steady_clock::now();
+    schedule();
+}
+
+void Replayer::step(long frames){
+    m_paused = true;
+    seek(frames);
+}
+
+void Replayer::seek(long frames){
+    long last = static_cast<long>(m_source.frames()) - 1;
+    long target = std::clamp(static_cast<long>(m_source.frame()) + frames, 0L, last);
+    if (target == static_cast<long>(m_source.frame())){
+        return;
+    }
+
+    show(static_cast<size_t>(target));
+    m_due = std::chrono::steady_clock::now();
+    schedule();
+}
+
+void Replayer::cycleSpeed(){
+    m_speed = m_speed >= MAX_REPLAY_SPEED ? 1 : m_speed * 2;
+}
+
+std::string Replayer::status() const{
+    std::time_t time = static_cast<std::time_t>(m_source.frameTimeMs() / 1000);
+    char clock[16];
+    std::strftime(clock, sizeof(clock), "%H:%M:%S", std::localtime(&time));
+
+    // fixed width, so a shorter status fully covers a longer one
+    int digits = std::snprintf(nullptr, 0, "%zu", m_source.frames());
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "replay %*zu/%zu %s | %-7s %2ux", digits, m_source.frame() + 1, m_source.frames(), clock,
+        m_paused ? "paused" : "playing", m_speed);
+    return buf;
+}
@@ -0,0 +1,192 @@
+#include <utility>
+
+#include "../include/sampler.hpp"
+
+Sampler::Sampler(std::chrono::milliseconds interval, size_t scan_workers, ProcBackend backend, bool pss)
+    : m_interval(interval), m_reader(scan_workers, backend, liveSource(), pss), m_pool(std::make_shared<SnapshotPool>()){}
+
+Sampler::~Sampler(){
+    stop();
+}
+
+void Sampler::start(){
+    if (m_thread.joinable()){
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = false;
+    }
+
+    m_thread = std::thread(&Sampler::run, this);
+}
+
+void Sampler::stop(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_requests.notify();
+
+    if (m_thread.joinable()){
+        m_thread.join();
+    }
+}
+
+std::shared_ptr<const SystemSnapshot> Sampler::latest() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_latest;
+}
+
+std::shared_ptr<const SystemSnapshot> Sampler::waitForFirst() const{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]{ return m_latest != nullptr || m_stop; });
+    return m_latest;
+}
+
+// reusing the spare buffer when there is one, so steady-state sampling keeps the vector and string capacities
+// a buffer only becomes the spare in its deleter: once the last reference is gone, in whichever thread dropped it,
+// so nobody can still be reading it (a use count is only a hint, the deleter runs after every other owner is done)
+std::shared_ptr<SystemSnapshot> Sampler::acquireBuffer(){
+    std::unique_ptr<SystemSnapshot> buffer;
+    {
+        std::lock_guard<std::mutex> lock(m_pool->mutex);
+        buffer = std::move(m_pool->spare);
+    }
+    if (!buffer){
+        buffer.reset(new SystemSnapshot());
+    }
+
+    // the deleter keeps the pool alive, snapshots the ui still holds may outlive the sampler
+    std::shared_ptr<SnapshotPool> pool = m_pool;
+    return std::shared_ptr<SystemSnapshot>(buffer.release(), [pool](SystemSnapshot *snapshot){
+        std::unique_ptr<SystemSnapshot> released(snapshot);
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if (!pool->spare){
+            pool->spare = std::move(released);
+        }
+    });
+}
+
+void Sampler::publish(std::shared_ptr<SystemSnapshot> snapshot){
+    snapshot->generation = ++m_generation;
+
+    // dropped on return, outside the lock: it becomes the spare once the ui has let go of it too
+    std::shared_ptr<const SystemSnapshot> previous;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        previous = std::move(m_latest);
+        m_latest = std::move(snapshot);
+    }
+    m_cv.notify_all();
+    m_published.notify();
+}
+
+void Sampler::requestCmdlines(const std::vector<int> &pids){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cmdline_request.assign(pids.begin(), pids.end());
+        m_cmdlines_requested = true;
+    }
+    m_requests.notify();
+}
+
+// taking over the latest request, the pids stay wanted until the ui asks for others
+void Sampler::takeCmdlineRequest(){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_cmdlines_requested){
+        m_cmdline_pids.assign(m_cmdline_request.begin(), m_cmdline_request.end());
+        m_cmdlines_requested = false;
+    }
+}
+
+void Sampler::requestShown(const std::vector<int> &pids){
+    // nothing to answer until the next sample, so the sampling thread is left asleep
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shown_request.assign(pids.begin(), pids.end());
+    m_shown_requested = true;
+}
+
+void Sampler::takeShownRequest(){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_shown_requested){
+        m_shown_pids.assign(m_shown_request.begin(), m_shown_request.end());
+        m_shown_requested = false;
+    }
+}
+
+void Sampler::requestCgroups(bool enabled){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_group_cgroups = enabled;
+}
+
+void Sampler::takeCgroupRequest(){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_reader.groupCgroups(m_group_cgroups);
+}
+
+// answering a command line request between samples: republishing the latest
+// snapshot with the new command lines filled in, counters stay as they were
+void Sampler::publishCmdlines(){
+    takeCmdlineRequest();
+
+    std::shared_ptr<const SystemSnapshot> latest = this->latest();
+    std::shared_ptr<SystemSnapshot> snapshot = acquireBuffer();
+    if (!m_reader.loadCmdlines(m_cmdline_pids, *latest, *snapshot)){
+        return; // everything asked for was cached already, the buffer goes back to the pool
+    }
+
+    publish(std::move(snapshot));
+}
+
+void Sampler::run(){
+    // first sample: utilization since boot, so the ui has something to show right away
+    {
+        std::shared_ptr<SystemSnapshot> snapshot = acquireBuffer();
+        m_reader.sample(*snapshot, m_cmdline_pids, m_shown_pids);
+        publish(std::move(snapshot));
+    }
+
+    // the kernel keeps the cadence from here on, a slow sample does not push the next one back
+    m_timer.start(m_interval);
+
+    pollfd fds[] = {{m_timer.fd(), POLLIN, 0}, {m_requests.fd(), POLLIN, 0}};
+    while (true){
+        // poll() failing is not transient, the thread stops rather than spinning
+        // (the ui keeps the last snapshot, and stop() still joins it)
+        if (waitForEvents(fds, 2, -1) < 0){
+            return;
+        }
+
+        // draining before looking, so a request coming in after the look wakes the next wait
+        m_requests.drain();
+        bool requested;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop){
+                return;
+            }
+            requested = m_cmdlines_requested;
+        }
+
+        // ticks missed while sampling took longer than the interval are dropped, not caught up on
+        if (m_timer.consume() > 0){
+            takeCmdlineRequest();
+            takeShownRequest();
+            takeCgroupRequest();
+
+            std::shared_ptr<SystemSnapshot> snapshot = acquireBuffer();
+            m_reader.sample(*snapshot, m_cmdline_pids, m_shown_pids);
+
+            publish(std::move(snapshot));
+            continue;
+        }
+
+        // the ui scrolled to rows whose command lines are missing, answering before the next sample
+        if (requested){
+            publishCmdlines();
+        }
+    }
+}
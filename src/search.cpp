@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <string_view>
+
+#include "../include/search.hpp"
+
+// ─────────────────────────────────────────────
+// ProcFilter
+// ─────────────────────────────────────────────
+
+static char lower(char c){
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+// whole-string number, false on anything else
+template <typename T>
+static bool parseWhole(std::string_view text, T &value){
+    const char *end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+// "512", "200m", "1g" into KB
+static bool parseMemKB(std::string_view text, unsigned long &kb){
+    unsigned long scale = 1;
+    if (!text.empty()){
+        switch (lower(text.back())){
+            case 'k': scale = 1; text.remove_suffix(1); break;
+            case 'm': scale = 1024; text.remove_suffix(1); break;
+            case 'g': scale = 1024 * 1024; text.remove_suffix(1); break;
+        }
+    }
+    if (!parseWhole(text, kb)){
+        return false;
+    }
+    kb *= scale;
+    return true;
+}
+
+static bool parseTerm(std::string_view term, ProcFilter &filter){
+    size_t colon = term.find(':');
+    if (colon == std::string_view::npos){
+        std::string name;
+        for (char c : term){
+            name.push_back(lower(c));
+        }
+        filter.names.push_back(std::move(name));
+        return true;
+    }
+
+    std::string_view key = term.substr(0, colon);
+    std::string_view value = term.substr(colon + 1);
+
+    if (key == "cmd"){
+        try {
+            filter.commands.emplace_back(value.begin(), value.end(), std::regex::ECMAScript | std::regex::icase | std::regex::optimize);
+        } catch (const std::regex_error&){
+            return false;
+        }
+        return true;
+    }
+    if (key == "pid"){
+        return parseWhole(value, filter.pid);
+    }
+    if (key == "ppid"){
+        return parseWhole(value, filter.ppid);
+    }
+    if (key == "mem"){
+        return parseMemKB(value, filter.min_mem_kb);
+    }
+    return false;
+}
+
+bool parseProcFilter(const std::string &text, ProcFilter &filter, std::string &error){
+    filter = ProcFilter();
+    error.clear();
+
+    std::string_view rest(text);
+    while (!rest.empty()){
+        size_t begin = rest.find_first_not_of(' ');
+        if (begin == std::string_view::npos){
+            break;
+        }
+        rest.remove_prefix(begin);
+
+        size_t end = std::min(rest.find(' '), rest.size());
+        std::string_view term = rest.substr(0, end);
+        rest.remove_prefix(end);
+
+        if (!parseTerm(term, filter) && error.empty()){
+            error.assign(term.begin(), term.end());
+        }
+    }
+
+    return error.empty();
+}
+
+
+// ─────────────────────────────────────────────
+// ProcSearchIndex
+// ─────────────────────────────────────────────
+
+uint32_t ProcSearchIndex::append(const std::string &text){
+    uint32_t offset = static_cast<uint32_t>(m_text.size());
+    for (char c : text){
+        m_text.push_back(lower(c));
+    }
+    return offset;
+}
+
+void ProcSearchIndex::compact(){
+    if (m_garbage < 4096 || m_garbage * 2 < m_text.size()){
+        return;
+    }
+
+    m_scratch.clear();
+    for (const auto &slot : m_slots){
+        Entry &e = m_entries[slot.second];
+
+        uint32_t name_offset = static_cast<uint32_t>(m_scratch.size());
+        m_scratch.append(m_text, e.name_offset, e.name_length);
+        e.name_offset = name_offset;
+
+        uint32_t cmd_offset = static_cast<uint32_t>(m_scratch.size());
+        m_scratch.append(m_text, e.cmd_offset, e.cmd_length);
+        e.cmd_offset = cmd_offset;
+    }
+
+    m_text.swap(m_scratch); // both keep their capacity for the next compaction
+    m_garbage = 0;
+}
+
+void ProcSearchIndex::update(const std::vector<ProcStat> &procs){
+    ++m_tick;
+    m_rows.resize(procs.size());
+
+    for (size_t i = 0; i < procs.size(); ++i){
+        const ProcStat &p = procs[i];
+
+        auto it = m_slots.find(p.pid);
+        if (it != m_slots.end() && m_entries[it->second].starttime != p.starttime){
+            // the pid was reused, indexing the new process from scratch
+            const Entry &old = m_entries[it->second];
+            m_garbage += old.name_length + old.cmd_length;
+            m_free.push_back(it->second);
+            m_slots.erase(it);
+            it = m_slots.end();
+        }
+
+        if (it == m_slots.end()){
+            uint32_t slot;
+            if (!m_free.empty()){
+                slot = m_free.back();
+                m_free.pop_back();
+            } else {
+                slot = static_cast<uint32_t>(m_entries.size());
+                m_entries.emplace_back();
+            }
+
+            Entry &e = m_entries[slot];
+            e.name_offset = append(p.process_name);
+            e.name_length = static_cast<uint32_t>(p.process_name.size());
+            e.cmd_offset = append(p.command_name);
+            e.cmd_length = static_cast<uint32_t>(p.command_name.size());
+            e.starttime = p.starttime;
+            e.seen = m_tick;
+
+            m_slots.emplace(p.pid, slot);
+            m_rows[i] = slot;
+            continue;
+        }
+
+        Entry &e = m_entries[it->second];
+        e.seen = m_tick;
+        m_rows[i] = it->second;
+
+        // processes can rename themselves (prctl, exec)
+        bool renamed = e.name_length != p.process_name.size();
+        for (uint32_t j = 0; !renamed && j < e.name_length; ++j){
+            renamed = m_text[e.name_offset + j] != lower(p.process_name[j]);
+        }
+        if (renamed){
+            m_garbage += e.name_length;
+            e.name_offset = append(p.process_name);
+            e.name_length = static_cast<uint32_t>(p.process_name.size());
+        }
+
+        // command lines are read once per pid, some time after the pid shows up
+        if (e.cmd_length == 0 && !p.command_name.empty()){
+            e.cmd_offset = append(p.command_name);
+            e.cmd_length = static_cast<uint32_t>(p.command_name.size());
+        }
+    }
+
+    // dropping exited processes
+    for (auto it = m_slots.begin(); it != m_slots.end();){
+        const Entry &e = m_entries[it->second];
+        if (e.seen == m_tick){
+            ++it;
+            continue;
+        }
+        m_garbage += e.name_length + e.cmd_length;
+        m_free.push_back(it->second);
+        it = m_slots.erase(it);
+    }
+
+    compact();
+}
+
+void ProcSearchIndex::match(const std::vector<ProcStat> &procs, const ProcFilter &filter, std::vector<int> &out) const{
+    out.clear();
+
+    for (size_t i = 0; i < procs.size() && i < m_rows.size(); ++i){
+        const ProcStat &p = procs[i];
+
+        // numeric terms first, they are the cheapest
+        if (filter.pid >= 0 && p.pid != filter.pid) continue;
+        if (filter.ppid >= 0 && p.ppid != filter.ppid) continue;
+        if (p.memb_kb < filter.min_mem_kb) continue;
+
+        const Entry &e = m_entries[m_rows[i]];
+        std::string_view name(m_text.data() + e.name_offset, e.name_length);
+
+        bool matched = true;
+        for (const std::string &term : filter.names){
+            if (name.find(term) == std::string_view::npos){
+                matched = false;
+                break;
+            }
+        }
+
+        // rows show the name while the command line is unknown (or empty, kernel threads), so matching that too
+        const char *cmd = e.cmd_length > 0 ? m_text.data() + e.cmd_offset : name.data();
+        size_t cmd_length = e.cmd_length > 0 ? e.cmd_length : e.name_length;
+        for (size_t j = 0; matched && j < filter.commands.size(); ++j){
+            matched = std::regex_search(cmd, cmd + cmd_length, filter.commands[j]);
+        }
+
+        if (matched){
+            out.push_back(static_cast<int>(i));
+        }
+    }
+}
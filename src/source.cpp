@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../include/profile.hpp"
+#include "../include/source.hpp"
+
+// ─────────────────────────────────────────────
+// ProcfsSource — the running system
+// ─────────────────────────────────────────────
+
+// read on every sample, so kept open instead of opened and closed each time
+static const char *const PERSISTENT_FILES[] = {"stat", "meminfo", "pressure/cpu", "pressure/memory", "pressure/io", "net/dev"};
+
+// reading from fd until end of file or size bytes, returns the number of bytes read or -1
+static ssize_t readAll(int fd, char *buf, size_t size){
+    size_t total = 0;
+    while (total < size){
+        ssize_t n = ::read(fd, buf + total, size - total);
+        if (n < 0){
+            if (errno == EINTR){
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0){
+            break;
+        }
+        total += n;
+    }
+    return static_cast<ssize_t>(total);
+}
+
+// preading fd from offset 0 until end of file or size bytes, returns the number of bytes read or -1
+// a proc file regenerates its contents when read from offset 0, so this is a fresh sample
+static ssize_t preadAll(int fd, char *buf, size_t size){
+    size_t total = 0;
+    while (total < size){
+        ssize_t n = pread(fd, buf + total, size - total, total);
+        if (n < 0){
+            if (errno == EINTR){
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0){
+            break;
+        }
+        total += n;
+    }
+    return static_cast<ssize_t>(total);
+}
+
+// re-reading a persistent fd into out, the buffer keeps the size of the previous read
+// and only grows (re-reading from the start so the contents stay one consistent sample)
+static bool preadAllInto(int fd, std::string &out){
+    size_t size = std::max<size_t>(out.capacity(), 256);
+    while (true){
+        out.resize(size);
+        ssize_t len = preadAll(fd, &out[0], size);
+        if (len < 0){
+            out.clear();
+            return false;
+        }
+        if (static_cast<size_t>(len) < size){
+            out.resize(len);
+            return true;
+        }
+        size *= 2;
+    }
+}
+
+// reading a whole file of any size relative to dir_fd into out, reusing its capacity
+static bool readAllAt(int dir_fd, const char *path, std::string &out){
+    int fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0){
+        out.clear();
+        return false;
+    }
+
+    // growing only for unusually long files
+    size_t total = 0;
+    out.resize(std::max<size_t>(out.capacity(), 256));
+    while (true){
+        if (total == out.size()){
+            out.resize(out.size() * 2);
+        }
+
+        ssize_t n = ::read(fd, &out[total], out.size() - total);
+        if (n < 0 && errno == EINTR){
+            continue;
+        }
+        if (n <= 0){
+            break;
+        }
+        total += n;
+    }
+    close(fd);
+
+    out.resize(total);
+    return true;
+}
+
+ProcfsSource::ProcfsSource(const char *root)
+    : m_proc_fd(open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC))
+{
+    for (const char *path : PERSISTENT_FILES){
+        m_persistent.push_back({path, openat(m_proc_fd, path, O_RDONLY | O_CLOEXEC)});
+    }
+}
+
+ProcfsSource::~ProcfsSource(){
+    for (const PersistentFile &file : m_persistent){
+        if (file.fd >= 0){
+            close(file.fd);
+        }
+    }
+    if (m_proc_fd >= 0){
+        close(m_proc_fd);
+    }
+}
+
+int ProcfsSource::persistentFd(const char *path) const{
+    for (const PersistentFile &file : m_persistent){
+        if (std::strcmp(file.path, path) == 0){
+            return file.fd;
+        }
+    }
+    return -1;
+}
+
+ssize_t ProcfsSource::read(const char *path, char *buf, size_t size){
+    int persistent = persistentFd(path);
+    if (persistent >= 0){
+        return preadAll(persistent, buf, size);
+    }
+
+    int fd = openat(m_proc_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0){
+        return -1;
+    }
+
+    ssize_t len = readAll(fd, buf, size);
+    close(fd);
+    return len;
+}
+
+bool ProcfsSource::read(const char *path, std::string &out){
+    int persistent = persistentFd(path);
+    if (persistent >= 0){
+        return preadAllInto(persistent, out);
+    }
+    return readAllAt(m_proc_fd, path, out);
+}
+
+void ProcfsSource::listPids(std::vector<int> &pids){
+    pids.clear();
+
+    // walking a fresh open of /proc, a dup() would share its directory offset with every other walk
+    int dir_fd = m_proc_fd >= 0 ? openat(m_proc_fd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC) : -1;
+    DIR *dir = dir_fd >= 0 ? fdopendir(dir_fd) : nullptr;
+    if (!dir){
+        if (dir_fd >= 0){
+            close(dir_fd);
+        }
+        return;
+    }
+
+    while (dirent *entry = readdir(dir)){
+        // skip if not a pid directory
+        if (entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN){
+            continue;
+        }
+
+        const char *name = entry->d_name;
+        const char *name_end = name + std::strlen(name);
+
+        int pid = 0;
+        std::from_chars_result parsed = std::from_chars(name, name_end, pid);
+        if (parsed.ec == std::errc() && parsed.ptr == name_end){
+            pids.push_back(pid);
+        }
+    }
+
+    closedir(dir);
+}
+
+bool ProcfsSource::readOSRelease(std::string &out){
+    return readAllAt(AT_FDCWD, "/etc/os-release", out);
+}
+
+std::time_t ProcfsSource::now(){
+    return std::time(nullptr);
+}
+
+uint64_t ProcfsSource::clockNs(){
+    return monotonicNs();
+}
+
+ProcSource &liveSource(){
+    static ProcfsSource source;
+    return source;
+}
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <linux/genetlink.h>
+#include <linux/netlink.h>
+#include <linux/taskstats.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "../include/taskstats.hpp"
+
+// ─────────────────────────────────────────────
+// netlink helpers
+// ─────────────────────────────────────────────
+
+// attribute payload
+static const char *attrData(const nlattr *attr){
+    return reinterpret_cast<const char*>(attr) + NLA_HDRLEN;
+}
+
+static int attrPayloadLength(const nlattr *attr){
+    return attr->nla_len - NLA_HDRLEN;
+}
+
+// sending one generic netlink request carrying a single attribute
+static bool sendRequest(int fd, uint16_t type, uint8_t cmd, uint8_t version, uint32_t seq, uint16_t attr_type, const void *data, size_t len){
+    struct {
+        nlmsghdr n;
+        genlmsghdr g;
+        char attrs[64];
+    } req;
+    std::memset(&req, 0, sizeof(req));
+
+    if (NLA_HDRLEN + len > sizeof(req.attrs)){
+        return false;
+    }
+
+    req.n.nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN);
+    req.n.nlmsg_type = type;
+    req.n.nlmsg_flags = NLM_F_REQUEST;
+    req.n.nlmsg_seq = seq;
+    req.g.cmd = cmd;
+    req.g.version = version;
+
+    nlattr *attr = reinterpret_cast<nlattr*>(reinterpret_cast<char*>(&req) + NLMSG_ALIGN(req.n.nlmsg_len));
+    attr->nla_type = attr_type;
+    attr->nla_len = NLA_HDRLEN + len;
+    std::memcpy(reinterpret_cast<char*>(attr) + NLA_HDRLEN, data, len);
+    req.n.nlmsg_len += NLA_ALIGN(attr->nla_len);
+
+    sockaddr_nl kernel;
+    std::memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+
+    while (true){
+        ssize_t sent = sendto(fd, &req, req.n.nlmsg_len, 0, reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel));
+        if (sent < 0 && errno == EINTR){
+            continue;
+        }
+        return sent == static_cast<ssize_t>(req.n.nlmsg_len);
+    }
+}
+
+// receiving the reply to seq into buf, returns its length or -1 on error replies
+static int receiveReply(int fd, uint32_t seq, char *buf, size_t size){
+    while (true){
+        ssize_t len = recv(fd, buf, size, 0);
+        if (len < 0){
+            if (errno == EINTR){
+                continue;
+            }
+            return -1;
+        }
+
+        const nlmsghdr *nh = reinterpret_cast<const nlmsghdr*>(buf);
+        if (!NLMSG_OK(nh, static_cast<unsigned int>(len))){
+            return -1;
+        }
+
+        // a late reply to an earlier request, skipping it
+        if (nh->nlmsg_seq != seq){
+            continue;
+        }
+
+        if (nh->nlmsg_type == NLMSG_ERROR){
+            const nlmsgerr *err = static_cast<const nlmsgerr*>(NLMSG_DATA(nh));
+            errno = -err->error;
+            return -1;
+        }
+
+        return static_cast<int>(len);
+    }
+}
+
+// walking the top-level attributes of the generic netlink reply in buf
+template <typename Fn>
+static void forEachAttr(const char *buf, int len, Fn fn){
+    const nlmsghdr *nh = reinterpret_cast<const nlmsghdr*>(buf);
+    const char *p = static_cast<const char*>(NLMSG_DATA(nh)) + GENL_HDRLEN;
+    int remaining = std::min<int>(len, nh->nlmsg_len) - NLMSG_LENGTH(GENL_HDRLEN);
+
+    while (remaining >= NLA_HDRLEN){
+        const nlattr *attr = reinterpret_cast<const nlattr*>(p);
+        if (attr->nla_len < NLA_HDRLEN || attr->nla_len > remaining){
+            return;
+        }
+
+        if (!fn(attr)){
+            return;
+        }
+
+        int step = NLA_ALIGN(attr->nla_len);
+        p += step;
+        remaining -= step;
+    }
+}
+
+// ─────────────────────────────────────────────
+// TaskstatsClient
+// ─────────────────────────────────────────────
+
+TaskstatsClient::~TaskstatsClient(){
+    if (m_fd >= 0){
+        close(m_fd);
+    }
+}
+
+bool TaskstatsClient::open(){
+    m_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    if (m_fd < 0){
+        return false;
+    }
+
+    // never blocking the sampler for long if the kernel does not answer
+    timeval timeout = {1, 0};
+    setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_nl local;
+    std::memset(&local, 0, sizeof(local));
+    local.nl_family = AF_NETLINK;
+
+    // resolving the TASKSTATS family id through the generic netlink controller
+    const char family_name[] = TASKSTATS_GENL_NAME;
+    bool resolved = bind(m_fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) == 0
+        && sendRequest(m_fd, GENL_ID_CTRL, CTRL_CMD_GETFAMILY, 1, ++m_seq, CTRL_ATTR_FAMILY_NAME, family_name, sizeof(family_name));
+
+    if (resolved){
+        int len = receiveReply(m_fd, m_seq, m_buf, sizeof(m_buf));
+        if (len > 0){
+            forEachAttr(m_buf, len, [this](const nlattr *attr){
+                if (attr->nla_type == CTRL_ATTR_FAMILY_ID && attrPayloadLength(attr) >= 2){
+                    std::memcpy(&m_family, attrData(attr), sizeof(m_family));
+                    return false;
+                }
+                return true;
+            });
+        }
+    }
+
+    // asking about ourselves tells whether queries are allowed at all
+    ProcStat self{};
+    if (m_family == 0 || !read(getpid(), self)){
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+int TaskstatsClient::query(uint16_t attr, uint32_t id){
+    if (!sendRequest(m_fd, m_family, TASKSTATS_CMD_GET, TASKSTATS_GENL_VERSION, ++m_seq, attr, &id, sizeof(id))){
+        return -1;
+    }
+    return receiveReply(m_fd, m_seq, m_buf, sizeof(m_buf));
+}
+
+const void *TaskstatsClient::findStats(int len, uint16_t aggr_type) const{
+    const void *stats = nullptr;
+
+    forEachAttr(m_buf, len, [&](const nlattr *attr){
+        if (attr->nla_type != aggr_type){
+            return true;
+        }
+
+        // the aggregate nests the id and the struct taskstats
+        const char *p = attrData(attr);
+        int remaining = attrPayloadLength(attr);
+        while (remaining >= NLA_HDRLEN){
+            const nlattr *nested = reinterpret_cast<const nlattr*>(p);
+            if (nested->nla_len < NLA_HDRLEN || nested->nla_len > remaining){
+                break;
+            }
+
+            // older kernels send a shorter struct, the fields read here are all in version 1
+            if (nested->nla_type == TASKSTATS_TYPE_STATS
+                && attrPayloadLength(nested) >= static_cast<int>(offsetof(taskstats, hiwater_vm) + sizeof(__u64))){
+                stats = attrData(nested);
+                break;
+            }
+
+            int step = NLA_ALIGN(nested->nla_len);
+            p += step;
+            remaining -= step;
+        }
+        return false;
+    });
+
+    return stats;
+}
+
+bool TaskstatsClient::read(int pid, ProcStat &ps){
+    if (m_fd < 0){
+        return false;
+    }
+
+    static const long clock_ticks = sysconf(_SC_CLK_TCK);
+
+    // per-tgid query: cpu time summed over every thread of the process
+    taskstats stats;
+    std::memset(&stats, 0, sizeof(stats));
+
+    int len = query(TASKSTATS_CMD_ATTR_TGID, static_cast<uint32_t>(pid));
+    const void *found = len > 0 ? findStats(len, TASKSTATS_TYPE_AGGR_TGID) : nullptr;
+    if (!found){
+        return false;
+    }
+    std::memcpy(&stats, found, offsetof(taskstats, hiwater_vm) + sizeof(__u64));
+
+    // microseconds to clock ticks, the unit /proc/<pid>/stat uses
+    ps.utime = static_cast<unsigned long>(stats.ac_utime * clock_ticks / 1000000);
+    ps.stime = static_cast<unsigned long>(stats.ac_stime * clock_ticks / 1000000);
+
+    return true;
+}
@@ -0,0 +1,128 @@
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <string>
+
+#include "../include/topology.hpp"
+
+// parsing the number after prefix in name (cpu12, node1), -1 if name is not prefix followed by digits
+static int numberAfter(const char *name, const char *prefix){
+    size_t len = std::strlen(prefix);
+    if (std::strncmp(name, prefix, len) != 0){
+        return -1;
+    }
+
+    const char *begin = name + len;
+    const char *end = begin + std::strlen(begin);
+    int number = -1;
+    std::from_chars_result parsed = std::from_chars(begin, end, number);
+    return parsed.ec == std::errc() && parsed.ptr == end && begin != end ? number : -1;
+}
+
+// reading a single integer file, -1 if it is missing
+static int readIntFile(const std::string &path){
+    FILE *file = std::fopen(path.c_str(), "r");
+    if (!file){
+        return -1;
+    }
+
+    int value = -1;
+    if (std::fscanf(file, "%d", &value) != 1){
+        value = -1;
+    }
+    std::fclose(file);
+    return value;
+}
+
+// the node a core belongs to, from the nodeN entry in its directory
+static int readNode(const std::string &cpu_dir){
+    DIR *dir = opendir(cpu_dir.c_str());
+    if (!dir){
+        return -1;
+    }
+
+    int node = -1;
+    while (dirent *entry = readdir(dir)){
+        node = numberAfter(entry->d_name, "node");
+        if (node >= 0){
+            break;
+        }
+    }
+
+    closedir(dir);
+    return node;
+}
+
+CpuTopology readCpuTopology(const char *root){
+    CpuTopology topology;
+
+    DIR *dir = opendir(root);
+    if (!dir){
+        return topology;
+    }
+
+    while (dirent *entry = readdir(dir)){
+        int cpu = numberAfter(entry->d_name, "cpu");
+        if (cpu < 0){
+            continue;
+        }
+
+        if (static_cast<size_t>(cpu) >= topology.socket.size()){
+            topology.socket.resize(cpu + 1, -1);
+            topology.node.resize(cpu + 1, -1);
+        }
+
+        std::string cpu_dir = std::string(root) + "/" + entry->d_name;
+        topology.socket[cpu] = readIntFile(cpu_dir + "/topology/physical_package_id");
+        topology.node[cpu] = readNode(cpu_dir);
+    }
+
+    closedir(dir);
+    return topology;
+}
+
+int CpuTopology::group(CpuGrouping grouping, int cpu) const{
+    const std::vector<int> *ids = grouping == CpuGrouping::Node ? &node : grouping == CpuGrouping::Socket ? &socket : nullptr;
+    if (!ids || cpu < 0 || static_cast<size_t>(cpu) >= ids->size()){
+        return -1;
+    }
+    return (*ids)[cpu];
+}
+
+// whether ids holds more than one known group
+static bool severalGroups(const std::vector<int> &ids){
+    int first = -1;
+    for (int id : ids){
+        if (id < 0){
+            continue;
+        }
+        if (first >= 0 && id != first){
+            return true;
+        }
+        first = id;
+    }
+    return false;
+}
+
+CpuGrouping CpuTopology::resolve(CpuGrouping grouping) const{
+    if (grouping != CpuGrouping::Auto){
+        return grouping;
+    }
+    if (severalGroups(node)){
+        return CpuGrouping::Node;
+    }
+    if (severalGroups(socket)){
+        return CpuGrouping::Socket;
+    }
+    return CpuGrouping::None;
+}
+
+const char *cpuGroupingName(CpuGrouping grouping){
+    switch (grouping){
+        case CpuGrouping::Auto: return "auto";
+        case CpuGrouping::Node: return "node";
+        case CpuGrouping::Socket: return "socket";
+        default: return "none";
+    }
+}
@@ -1,542 +1,235 @@
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
 #include <cstddef>
+#include <cstdio>
+#include <cstring>
 #include <ncurses.h>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <unistd.h>
 #include <vector>
 #include <signal.h>
+#include <sys/ioctl.h>
+#include "../include/events.hpp"
+#include "../include/panels.hpp"
 #include "../include/reader.hpp"
+#include "../include/replay.hpp"
+#include "../include/sampler.hpp"
+#include "../include/ui.hpp"
 
-// global flag set by signal handler
-// setting it to volatile to let compiler know that the value can change outside program flow
-static volatile sig_atomic_t g_resized = 0;
+// frames '[' and ']' jump while replaying
+static const long REPLAY_SEEK_FRAMES = 10;
 
-void onResize(int) {
-    g_resized = 1;
-}
-
-// ─────────────────────────────────────────────
-// Panel — base class for all panels
-// ─────────────────────────────────────────────
-class Panel{
-protected:
-    WINDOW *win; // window
-    std::string m_title; // title
-    int m_title_color_pair; // color pair
-    int m_height, m_width; // height and width of the window
-    int m_pos_y, m_pos_x; // position of the window
-
-public:
-    // constructor
-    Panel
-    (
-        const std::string& title,
-        int title_color_pair,
-        int height,
-        int width,
-        int pos_y,
-        int pos_x
-    )
-    :
-        win(newwin(height, width, pos_y, pos_x)),
-        m_title(title),
-        m_title_color_pair(title_color_pair),
-        m_height(height),
-        m_width(width),
-        m_pos_y(pos_y),
-        m_pos_x(pos_x)
-    {}
-
-    // destructor
-    virtual ~Panel() {
-        if (win){
-            delwin(win);
-        }
-    }
+// processes whose cpu and memory trends are kept, by each measure
+static const size_t HISTORY_TOP_PROCS = 16;
 
-    // to prevent accidental copying
-    Panel(const Panel&) = delete;
-    Panel& operator=(const Panel&) = delete;
+// how often the self stats overlay re-reads /proc/self while open
+static const uint64_t SELF_USAGE_INTERVAL_NS = 1000000000;
 
-    // drawing panel
-    void drawPanel(){
-        box(win,0,0); // drawing outer border
-
-        // title of the panel
-        wattron(win, COLOR_PAIR(m_title_color_pair) | A_BOLD);
-        mvwprintw(win, 0, 1, " %s ", m_title.c_str());
-        wattroff(win, COLOR_PAIR(m_title_color_pair) | A_BOLD);
-
-        wnoutrefresh(win); // marking window for update
-    }
-
-    // resizing the panel
-    void rebuild(int height, int width, int pos_y, int pos_x) {
-        if (win) {
-            delwin(win);
-        }
-        m_height = height;
-        m_width  = width;
-        m_pos_y  = pos_y;
-        m_pos_x  = pos_x;
-        win = newwin(height, width, pos_y, pos_x);
-    }
+// what the panel under the top row shows
+enum class ListView{
+    Procs,
+    Cgroups,
+    Net
 };
 
 // ─────────────────────────────────────────────
-// System Info Panel — displays system info
-// extends Panel class
+// Helpers
 // ─────────────────────────────────────────────
-class SystemInfoPanel : public Panel {
-private:
-    void drawVisuals(){
-
-        // os name
-        std::string os_name = getOSName();
-        mvwprintw(win, 2, 1, " %s ", os_name.c_str());
 
-        // time
-        std::string system_time = getOSTime();
-        mvwprintw(win, 4, 1, " %s ", system_time.c_str());
+// function to handle program inputs, replayer is nullptr unless replaying a capture
+// returns -1 to quit, 1 if the screen needs redrawing and 0 if no key was pressed
+int handleInput(ProcPanel &procPanel, CgroupPanel &cgroupPanel, NetPanel &netPanel, Replayer *replayer, bool &show_profile, ListView &view){
+    int ch = getch();
 
-        // number of processes
-        int num_procs = listNumberOfProcDirectories();
-        mvwprintw(win, 6, 1, " Total number of processes: %d ", num_procs);
+    if (ch == ERR){
+        return 0;
     }
 
-public:
-    SystemInfoPanel(
-        int height, // height of the panel
-        int width, // width of the panel
-        int y, // y coordinate of the panel
-        int x // x coordinate of the panel
-    )
-    :
-    Panel(
-        "sys_info", // title
-        2, // color pair
-        height,
-        width,
-        y,
-        x) {}
-
-
-    // function to draw system info
-    void drawSysInfo(){
-        // drawing the system info panel first
-        drawPanel();
-
-        // drawing visuals
-        drawVisuals();
-
-        wnoutrefresh(win); // refreshing window (system info panel contents)
+    // the search prompt takes every key until enter or esc
+    if (procPanel.editingFilter()){
+        procPanel.editFilter(ch);
+        return 1;
     }
-};
-
-
-// ─────────────────────────────────────────────
-// Procs Panel — displays processes
-// extends Panel class
-// ─────────────────────────────────────────────
-class ProcPanel : public Panel {
-private:
-    std::vector<ProcStat> m_procs;
-    int m_page = 0;
-
-    void drawVisuals(){
-        int win_width = getmaxx(win);
-
-        // column header
-        wattron(win, A_BOLD | COLOR_PAIR(7));
-        mvwprintw(win, 1, 2, "%-6s %-20s %-6s %-10s %s", "PID", "NAME", "THR", "MEM(KB)", "COMMAND");
-        wattroff(win, A_BOLD | COLOR_PAIR(7));
-
-        // divider
-        mvwprintw(win, 2, 2, "%s", std::string(win_width - 4, '-').c_str());
-
-
-        int max_rows = m_height - 4;
-        int start = m_page * max_rows;
-        int end = std::min(start + max_rows, static_cast<int>(m_procs.size()));
-        int row = 3;
-
-
-        for (int i = start; i<end; i++){
-            const ProcStat &p = m_procs[i];
-
-            // truncating command to fit in remaining width
-            // 2 margin + 6pid + 1 + 20 name + 1 + 6 thr + 1 + 10 mem + 1 + 2 margin
-            std::string cmd = p.command_name.empty() ? p.process_name : p.command_name;
-            int cmd_max = win_width - 50;
-            if (cmd_max>0 && static_cast<int>(cmd.size())>cmd_max){
-                cmd = cmd.substr(0, cmd_max);
-            }
-
-
-            // adding color based on memory usage
-            int color;
-            if (p.memb_kb>500000){
-                color = 3; // red - 500MB
-            } else if (p.memb_kb > 100000) {
-                color = 2; // yellow - 100MB
-            }
-            // else {
-            //     color = 1;
-            // }
-
-            // drawing the row
-            mvwhline(win, row, 2, ' ', win_width - 4); // clearing row
-            wattron(win, COLOR_PAIR(color));
-            mvwprintw(win, row++, 2, "%-6d %-20.20s %-6d %-10lu %s", p.pid, p.process_name.c_str(), p.threads, p.memb_kb, cmd.c_str());
-            wattroff(win, COLOR_PAIR(color));
+    if (netPanel.editingFilter()){
+        netPanel.editFilter(ch);
+        return 1;
+    }
+    // the cgroup view has no prompt of its own, so the proc filter is only opened where it is drawn
+    if (ch == '/' && view != ListView::Cgroups){
+        if (view == ListView::Net){
+            netPanel.startFilter();
+        } else {
+            procPanel.startFilter();
         }
-
-        // page indicator at the bottom
-        int total_pages = (static_cast<int>(m_procs.size()) + max_rows - 1)/max_rows;
-        mvwprintw(win, m_height-1, 2, "page %d/%d", m_page+1, total_pages);
+        return 1;
     }
 
-
-public:
-    ProcPanel(
-        int height, // height of the panel
-        int width, // width of the panel
-        int y, // y coordinate of the panel
-        int x // x coordinate of the panel
-    )
-    :
-    Panel(
-        "proc", // title
-        1, // color pair
-        height,
-        width,
-        y,
-        x) {}
-
-
-    // function to draw proc stats
-    void drawProcStats(){
-        m_procs = getProcStats();
-
-        // drawing the proc panel first
-        drawPanel();
-
-        // drawing visuals
-        drawVisuals();
-
-        wnoutrefresh(win); // refreshing window (proc panel contents)
-
+    // user pressed 'q' or 'esc'
+    if (ch == 'q' || ch == 27){
+        return -1;
     }
 
-    void changePage(int direction){
-        m_page += direction;
-
-        // restricting to valid range
-        int max_rows = m_height - 4;
-        int total_pages = (static_cast<int>(m_procs.size()) + max_rows - 1)/max_rows;
-
-        if (m_page < 0){
-            m_page = 0;
-        }
-
-        if (m_page >= total_pages){
-            m_page = total_pages -1;
-        }
+    // toggling the self stats overlay
+    if (ch == 'o'){
+        show_profile = !show_profile;
     }
 
-};
-
-// ─────────────────────────────────────────────
-// MemPanel — displays memory utilisation
-// extends Panel class
-// ─────────────────────────────────────────────
-class MemPanel : public Panel{
-private:
-    MemStat m_mem_info;
-    unsigned long long m_active_memory; // truly used memory (green)
-    unsigned long long m_buffer; // buffers (blue)
-    unsigned long long m_cached; // cache (yellow)
-    unsigned long long m_free; // free (space)
-    unsigned long long m_total; // total space
-
-    // function to get memory stats
-    void getMemStats(){
-        m_mem_info = getMemInfo();
-        m_active_memory = m_mem_info.used_kb - m_mem_info.buffers_kb - m_mem_info.cached_kb;
-        m_buffer = m_mem_info.buffers_kb;
-        m_cached = m_mem_info.cached_kb;
-        m_free = m_mem_info.free_kb;
-        m_total = m_mem_info.total_kb;
+    // grouping processes by cgroup, captures hold no cgroup files
+    if (ch == 'g' && !replayer){
+        view = view == ListView::Cgroups ? ListView::Procs : ListView::Cgroups;
     }
 
-    // function to calculate number of bars
-    std::vector<int> calculateBars(int container_width, const unsigned long long& total_memory, const unsigned long long& active_memory, const unsigned long long& buffer, const unsigned long long& cached){
-
-        if (total_memory == 0) {
-            return {0, 0, 0, 0};
-        }
-
-        int active_memory_bars = static_cast<int>(container_width * (static_cast<double>(active_memory) / total_memory));
-        int buffer_memory_bars = static_cast<int>(container_width * (static_cast<double>(buffer) / total_memory));
-        int cached_memory_bars = static_cast<int>(container_width * (static_cast<double>(cached) / total_memory));
-
-        return {active_memory_bars, buffer_memory_bars, cached_memory_bars};
+    // network interfaces in place of the processes, and hiding the idle ones
+    if (ch == 'i'){
+        view = view == ListView::Net ? ListView::Procs : ListView::Net;
     }
-
-
-
-    void drawVisuals(){
-        // calculating width of the bar container
-        int bar_container_width = getmaxx(win) - 6;
-
-        // getting memory stats
-        getMemStats();
-
-        // calculating bars
-        std::vector<int> barsCount = calculateBars(bar_container_width, m_total, m_active_memory, m_buffer, m_cached);
-
-        // setting bars
-        std::string active_bars(barsCount[0], '|');
-        std::string buffer_bars(barsCount[1], '|');
-        std::string cached_bars(barsCount[2], '|');
-        // free 'spaces'
-        int used = barsCount[0] + barsCount[1] + barsCount[2];
-        int free_bar_count = bar_container_width - used;
-        std::string free_bars(std::max(0, free_bar_count), ' ');
-
-
-        // drawing the bars
-        mvwprintw(win, 1, 2, "[");
-
-        wattron(win, COLOR_PAIR(1) | A_BOLD);
-        wprintw(win, "%s", active_bars.c_str());
-        wattroff(win, COLOR_PAIR(1) | A_BOLD);
-
-        wattron(win, COLOR_PAIR(4) | A_BOLD);
-        wprintw(win, "%s", buffer_bars.c_str());
-        wattroff(win, COLOR_PAIR(4) | A_BOLD);
-
-        wattron(win, COLOR_PAIR(2) | A_BOLD);
-        wprintw(win, "%s", cached_bars.c_str());
-        wattroff(win, COLOR_PAIR(2) | A_BOLD);
-
-        wprintw(win, "%s", free_bars.c_str());
-
-        wprintw(win, "]");
-
-
-        // drawing usage stats
-        double used_gb  = static_cast<double>(m_mem_info.used_kb)  / (1024 * 1024);
-        double total_gb = static_cast<double>(m_mem_info.total_kb) / (1024 * 1024);
-        mvwprintw(win, 3, 2, "Usage: %.2fG/%.1fG", used_gb, total_gb);
-
-        // active memory
-        double active_gb = static_cast<double>(m_active_memory) / (1024 * 1024);
-        wattron(win, COLOR_PAIR(1) | A_BOLD);
-        mvwprintw(win, 5, 2, "Active:\t");
-        wattroff(win, COLOR_PAIR(1) | A_BOLD);
-        wprintw(win," %.2fG", active_gb);
-
-        // buffer
-        double buffer_gb = static_cast<double>(m_buffer) / (1024 * 1024);
-        wattron(win, COLOR_PAIR(4) | A_BOLD);
-        mvwprintw(win, 6, 2, "Buffer: \t");
-        wattroff(win, COLOR_PAIR(4) | A_BOLD);
-        wprintw(win," %.2fG", buffer_gb);
-
-        // cached memory
-        double cache_gb = static_cast<double>(m_cached) / (1024 * 1024);
-        wattron(win, COLOR_PAIR(2) | A_BOLD);
-        mvwprintw(win, 7, 2, "Cache:\t");
-        wattroff(win, COLOR_PAIR(2) | A_BOLD);
-        wprintw(win," %.2fG", cache_gb);
-
-        // free memory
-        double free_gb = static_cast<double>(m_free) / (1024 * 1024);
-        wattron(win, COLOR_PAIR(8) | A_BOLD);
-        mvwprintw(win, 8, 2, "Free: \t");
-        wattroff(win, COLOR_PAIR(8) | A_BOLD);
-        wprintw(win," %.2fG", free_gb);
+    if (ch == 'a' && view == ListView::Net){
+        netPanel.toggleIdle();
     }
 
-
-public:
-    MemPanel(
-        int height, // height of the panel
-        int width, // width of the panel
-        int y, // y coordinate of the panel
-        int x // x coordinate of the panel
-    )
-    :
-    Panel(
-        "mem", // title
-        5, // color pair
-        height,
-        width,
-        y,
-        x) {}
-
-
-    // function to draw memory stats
-    void drawMemStats(){
-        // drawing the memory panel first
-        drawPanel();
-
-        // drawing visuals
-        drawVisuals();
-
-        wnoutrefresh(win); // refreshing window (mem panel contents)
-
+    // changing the page of whichever list is shown
+    if (ch == KEY_RIGHT || ch == KEY_LEFT){
+        int direction = ch == KEY_RIGHT ? 1 : -1;
+        if (view == ListView::Cgroups){
+            cgroupPanel.changePage(direction);
+        } else if (view == ListView::Net){
+            netPanel.changePage(direction);
+        } else {
+            procPanel.changePage(direction);
+        }
     }
-};
 
-// ─────────────────────────────────────────────
-// CPUPanel — displays per-core CPU utilisation
-// extends Panel class
-// ─────────────────────────────────────────────
-class CPUPanel : public Panel{
-private:
-    std::vector<CPUStat> prev_results; // storing previous results
-    std::vector<CPUStat> curr_results; // storing current results
-    std::vector<CPUStat> delta_results; // storing the results of the difference b/w previous and current
-
-
-    // function to generate bars
-    std::string generateBars(int container_width, double utilization_percent) {
-        if (container_width <= 0){
-            return "";
+    // changing sort order: the net view has its own keys, the proc ones also order the cgroups
+    if (view == ListView::Net){
+        if (ch == 'b'){
+            netPanel.setSortKey(NetSortKey::Throughput);
         }
-
-        // normalizing to 0..1
-        double utilization = utilization_percent / 100.0;
-
-        // containing
-        if (utilization < 0.0){
-            utilization = 0.0;
+        if (ch == 'r'){
+            netPanel.setSortKey(NetSortKey::Rx);
         }
-        if (utilization > 1.0){
-            utilization = 1.0;
+        if (ch == 't'){
+            netPanel.setSortKey(NetSortKey::Tx);
+        }
+        if (ch == 'n'){
+            netPanel.setSortKey(NetSortKey::Name);
+        }
+    } else {
+        if (ch == 'p'){
+            procPanel.setSortKey(ProcSortKey::Pid);
+        }
+        if (ch == 'n'){
+            procPanel.setSortKey(ProcSortKey::Name);
+        }
+        if (ch == 't'){
+            procPanel.setSortKey(ProcSortKey::Threads);
+        }
+        if (ch == 'm'){
+            procPanel.setSortKey(ProcSortKey::Memory);
+        }
+        if (ch == 'v'){
+            procPanel.setSortKey(ProcSortKey::Vsize);
+        }
+        if (ch == 'c'){
+            procPanel.setSortKey(ProcSortKey::Cpu);
+        }
+        if (ch == 'r'){
+            procPanel.setSortKey(ProcSortKey::ReadRate);
+        }
+        if (ch == 'w'){
+            procPanel.setSortKey(ProcSortKey::WriteRate);
+        }
+        if (ch == 's'){
+            procPanel.setSortKey(ProcSortKey::Syscalls);
         }
-
-        int total_bars = (container_width * utilization);
-        int total_space = container_width - total_bars;
-
-        return std::string(total_bars, '|') + std::string(total_space, ' ');
     }
 
-    // function to get color
-    int getColor(double utilization){
-        if (utilization <= 50){
-            return 1;
-        } else if (utilization <= 80){
-            return 2;
-        } else {
-            return 3;
+    // replay controls: pause, step, seek and fast-forward
+    if (replayer){
+        if (ch == ' '){
+            replayer->togglePause();
+        }
+        if (ch == '.' || ch == ','){
+            replayer->step(ch == '.' ? 1 : -1);
+        }
+        if (ch == ']' || ch == '['){
+            replayer->seek(ch == ']' ? REPLAY_SEEK_FRAMES : -REPLAY_SEEK_FRAMES);
+        }
+        if (ch == 'f'){
+            replayer->cycleSpeed();
         }
     }
 
-    // function to draw visuals on the terminal
-    void drawVisual(const CPUStat& result, int row) {
-        // CPU name and utilization
-        const std::string& cpu_title = result.cpu;
-        double utilization = result.cpu_usage_percent;
-
-        // containing utilization to [0, 100] just in case
-        if (utilization < 0.0) utilization = 0.0;
-        if (utilization > 100.0) utilization = 100.0;
-
-        // calculating width for the bars container
-        int window_width = getmaxx(win);
-
-        // left margin + cpu title length + ' [' + '] ' + percentage + right margin
-        int fixed_width = 2 + 6 + 2 + 2 + 7 + 2;
-        int bars_container_width = window_width - fixed_width;
-        if (bars_container_width < 1) bars_container_width = 1;
-
-        // generating visual bar string
-        std::string bars = generateBars(bars_container_width, utilization);
-
-        // getting color pair
-        int color_pair = getColor(utilization);
-
-        // displaying CPU info
-        mvwprintw(win, row, 2, "%-5s [", cpu_title.c_str());
-        wattron(win, COLOR_PAIR(color_pair) | A_BOLD);
-        wprintw(win, "%s", bars.c_str());
-        wattroff(win, COLOR_PAIR(color_pair) | A_BOLD);
-        wprintw(win, "] %6.2f%%", utilization); // fixed width percentage
-    }
+    return 1;
+}
 
-public:
-    CPUPanel(
-        int height, // height of the panel
-        int width, // width of the panel
-        int y, // y coordinate of the panel
-        int x // x coordinate of the panel
-    )
-    :
-    Panel(
-        "cpu", // title
-        4, // color pair
-        height,
-        width,
-        y,
-        x) {}
-
-    // function to draw CPU stats
-    void drawCPUStats(){
-
-        // drawing the cpu panel first
-        drawPanel();
-
-        // main cpu stat
-        if (!delta_results.empty()){
-            drawVisual(delta_results[0],2);
-
-            mvwprintw(win, 3, 2, "%s", std::string(getmaxx(win) - 4, '-').c_str());
-
-            size_t row = 4;
-            for (size_t i=1; i<delta_results.size(); ++i){
-                drawVisual(delta_results[i], row++);
-            }
+// handling every key typed since the last wait, returns -1 to quit and 1 if the screen needs redrawing
+int handleKeys(ProcPanel &procPanel, CgroupPanel &cgroupPanel, NetPanel &netPanel, Replayer *replayer, bool &show_profile, ListView &view){
+    int result = 0;
+    while (true){
+        int input = handleInput(procPanel, cgroupPanel, netPanel, replayer, show_profile, view);
+        if (input <= 0){
+            return input == 0 ? result : -1;
         }
-
-
-        wnoutrefresh(win); // refreshing window (cpu panel contents)
+        result = 1;
     }
+}
 
-    // function to get cpu stats
-    void getCPUStats(){
-        prev_results = getIdleAndBusyTime();
-        sleep(1);
-        curr_results = getIdleAndBusyTime();
-        delta_results = calculateDeltaTime(prev_results, curr_results);
+// sleeping in poll() until a key, a resize or a newly published snapshot, or timeout_ms (-1 waits for ever)
+// returns false once the terminal is gone, or with the reason in error if poll() itself failed
+bool waitForWakeup(SignalWatch &signals, Sampler *sampler, int timeout_ms, bool &resized, std::string &error){
+    pollfd fds[] = {
+        {STDIN_FILENO, POLLIN, 0},
+        {signals.fd(), POLLIN, 0},
+        {sampler ? sampler->publishedFd() : -1, POLLIN, 0}, // negative fds are skipped by poll()
+    };
+    if (waitForEvents(fds, 3, timeout_ms) < 0){
+        error = std::string("poll: ") + std::strerror(errno);
+        return false;
     }
-};
 
+    while (int sig = signals.next()){
+        resized = resized || sig == SIGWINCH;
+    }
+    if (sampler && (fds[2].revents & POLLIN)){
+        sampler->clearPublished(); // the snapshot itself is picked up at the top of the loop
+    }
+    return !(fds[0].revents & (POLLHUP | POLLERR | POLLNVAL));
+}
 
-// ─────────────────────────────────────────────
-// Helpers
-// ─────────────────────────────────────────────
+// telling ncurses the new terminal size, SIGWINCH comes through a signalfd so its own handler never runs
+void resizeToTerminal(){
+    winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0){
+        resizeterm(size.ws_row, size.ws_col);
+    }
+}
 
-// function to handle program inputs
-int handleInput(ProcPanel &procPanel){
-    int ch = getch();
 
-    // user pressed 'q' or 'esc'
-    if (ch == 'q' || ch == 27){
-        return -1;
+// bytes this thread has written so far, from /proc/thread-self/io
+// the ui thread writes nothing but terminal output, so deltas are the bytes sent to the tty
+unsigned long long ttyBytesWritten(){
+    char buf[512];
+    ssize_t len = liveSource().read("thread-self/io", buf, sizeof(buf));
+    if (len <= 0){
+        return 0;
     }
 
-    // changing proc page
-    if (ch == KEY_RIGHT){
-        procPanel.changePage(1);
-    }
-    if (ch == KEY_LEFT){
-        procPanel.changePage(-1);
+    const char *key = "wchar:";
+    const char *end = buf + len;
+    const char *p = static_cast<const char*>(memmem(buf, len, key, std::strlen(key)));
+    if (!p){
+        return 0;
     }
+    p += std::strlen(key);
+    while (p < end && *p == ' ') ++p;
 
-    return 0;
+    unsigned long long written = 0;
+    std::from_chars(p, end, written);
+    return written;
 }
 
 
@@ -571,25 +264,51 @@ std::vector<int> getTerminalHeightWidth(){
 }
 
 
+// cpu panel height: one row per core plus the total, its divider and the borders
+// the cpu panel takes the rows its cores need, but at most half the terminal
+// (many cores switch it to a denser layout rather than pushing the process list off screen)
+int cpuPanelHeight(CPUPanel &cpuPanel, const SystemSnapshot &snapshot, int terminal_height, int width){
+    return cpuPanel.fitHeight(snapshot, width, std::max(terminal_height / 2, CPU_PANEL_CHROME + 1));
+}
+
+
 // ─────────────────────────────────────────────
 // Main UI loop
 // ─────────────────────────────────────────────
-void drawUI(){
+// returns false with the reason in error if the loop could not go on waiting for events
+bool drawUI(const Options &options, Replayer *replayer, SignalWatch &signals, std::string &error){
 
-    signal(SIGWINCH, onResize);
-
-    std::string quit_text = "press 'q' or 'esc' to exit";
+    std::string quit_text = replayer ? "space , . [ ] f i o | press 'q' or 'esc' to exit" : "g cgroups | i net | o self stats | press 'q' or 'esc' to exit";
 
     int terminal_height = getTerminalHeightWidth()[0];
     int terminal_width = getTerminalHeightWidth()[1];
 
+    // starting the sampler, every /proc read happens on its thread from here on
+    // (replaying, snapshots come from the capture instead)
+    std::unique_ptr<Sampler> sampler;
+    std::shared_ptr<const SystemSnapshot> snapshot;
+    if (replayer){
+        snapshot = replayer->latest();
+    } else {
+        sampler.reset(new Sampler(options.sample_interval, options.scan_workers, options.proc_backend, options.pss));
+        sampler->start();
+        snapshot = sampler->waitForFirst();
+    }
+
+    // trends for the sparklines, sized once for the whole run
+    History history(options.history_samples, snapshot->num_cpus, HISTORY_TOP_PROCS);
+    unsigned long pushed_sample = 0; // sample of the snapshot last added to history
+
     // initializing main panel
-    Panel mainPanel("vtop", 6, terminal_height, terminal_width, 0, 0);
+    MainPanel mainPanel(terminal_height, terminal_width);
 
     // initializing cpu panel
-    int cpu_panel_height = static_cast<int>(getIdleAndBusyTime().size()) + 4;
+    // (a replayed capture comes from another machine, its cores are not grouped)
     int cpu_panel_width = terminal_width/2 - 2;
-    CPUPanel cpuPanel(cpu_panel_height, cpu_panel_width, 1, 2);
+    CPUPanel cpuPanel(1, cpu_panel_width, 1, 2);
+    cpuPanel.setTopology(replayer ? CpuTopology() : readCpuTopology(), options.cpu_grouping);
+    int cpu_panel_height = cpuPanelHeight(cpuPanel, *snapshot, terminal_height, cpu_panel_width);
+    cpuPanel.rebuild(cpu_panel_height, cpu_panel_width, 1, 2);
 
     // initializing system info panel
     int sys_info_panel_height = static_cast<int>(cpu_panel_height / 2);
@@ -601,38 +320,83 @@ void drawUI(){
     int mem_panel_width = cpu_panel_width;
     MemPanel memPanel(mem_panel_height, mem_panel_width, sys_info_panel_height + 1, cpu_panel_width + 2);
 
+    // initializing pressure panel, a strip over the process list
+    // (left out on kernels without pressure stall information, and for captures taken on one)
+    int pressure_panel_height = PressurePanel::available(*snapshot) ? PRESSURE_PANEL_HEIGHT : 0;
+    std::unique_ptr<PressurePanel> pressurePanel;
+    if (pressure_panel_height > 0){
+        pressurePanel.reset(new PressurePanel(pressure_panel_height, terminal_width - 4, cpu_panel_height + 1, 2));
+    }
+
     // initializing proc panel
-    int proc_panel_height = static_cast<int>(terminal_height - cpu_panel_height - 2);
+    int proc_panel_top = cpu_panel_height + 1 + pressure_panel_height;
+    int proc_panel_height = static_cast<int>(terminal_height - proc_panel_top - 1);
     int proc_panel_width = terminal_width - 4;
-    ProcPanel procPanel(proc_panel_height, proc_panel_width, cpu_panel_height + 1, 2);
-
+    ProcPanel procPanel(proc_panel_height, proc_panel_width, proc_panel_top, 2);
+    procPanel.setPss(options.pss && !replayer); // captures hold no smaps_rollup
+
+    // cgroup view, drawn in place of the proc panel while toggled on
+    CgroupPanel cgroupPanel(proc_panel_height, proc_panel_width, proc_panel_top, 2);
+    bool cgroups_requested = false; // what the sampler was last asked for
+
+    // network interfaces, also in place of the proc panel
+    NetPanel netPanel(proc_panel_height, proc_panel_width, proc_panel_top, 2);
+
+    ListView view = ListView::Procs; // toggled on
+    ListView view_shown = ListView::Procs; // on screen
+
+    // self stats overlay, in the top right corner of the proc panel
+    ProfilePanel profilePanel(proc_panel_top + 1, terminal_width - ProfilePanel::width() - 3);
+    bool show_profile = false; // overlay toggled on
+    bool profile_shown = false; // overlay on screen
+    SelfUsage self_usage;
+    uint64_t self_usage_ns = 0; // when self_usage was last updated
+
+    unsigned long long tty_written = ttyBytesWritten(); // tty bytes written before the last frame
+    unsigned long long frame_bytes = 0; // tty bytes written by the last frame
+    std::string status;
+
+    unsigned long drawn_generation = 0; // generation of the snapshot on screen
+    bool dirty = true; // screen needs redrawing
+    bool resized = false; // SIGWINCH arrived since the layout was last computed
+    std::vector<int> cmdline_window; // pids whose command lines were last requested
+    std::vector<int> next_cmdline_window;
+    std::vector<int> shown_window; // pids on the page, whose disk i/o and PSS were last requested
+    std::vector<int> next_shown_window;
 
     while (true){
 
         // handling resize
-        if (g_resized) {
-            g_resized = 0;
-            endwin();
-            refresh();
+        if (resized) {
+            resized = false;
+            dirty = true;
+            resizeToTerminal();
             clear();
 
             terminal_height = getTerminalHeightWidth()[0];
             terminal_width  = getTerminalHeightWidth()[1];
 
             // recalculating dimensions
-            cpu_panel_height = static_cast<int>(getIdleAndBusyTime().size()) + 4;
             cpu_panel_width  = terminal_width / 2 - 2;
+            cpu_panel_height = cpuPanelHeight(cpuPanel, *snapshot, terminal_height, cpu_panel_width);
 
             int sys_info_h = cpu_panel_height / 2;
             int mem_h = cpu_panel_height / 2 + 1;
-            int proc_h = terminal_height - cpu_panel_height - 2;
+            proc_panel_top = cpu_panel_height + 1 + pressure_panel_height;
+            int proc_h = terminal_height - proc_panel_top - 1;
             int proc_w = terminal_width - 4;
 
             mainPanel.rebuild(terminal_height, terminal_width, 0, 0);
             cpuPanel.rebuild(cpu_panel_height, cpu_panel_width, 1, 2);
             sysInfoPanel.rebuild(sys_info_h, cpu_panel_width, 1, cpu_panel_width + 2);
             memPanel.rebuild(mem_h, cpu_panel_width, sys_info_h + 1, cpu_panel_width + 2);
-            procPanel.rebuild(proc_h, proc_w, cpu_panel_height + 1, 2);
+            if (pressurePanel){
+                pressurePanel->rebuild(pressure_panel_height, proc_w, cpu_panel_height + 1, 2);
+            }
+            procPanel.rebuild(proc_h, proc_w, proc_panel_top, 2);
+            cgroupPanel.rebuild(proc_h, proc_w, proc_panel_top, 2);
+            netPanel.rebuild(proc_h, proc_w, proc_panel_top, 2);
+            profilePanel.rebuild(ProfilePanel::height(), ProfilePanel::width(), proc_panel_top + 1, terminal_width - ProfilePanel::width() - 3);
         }
 
         // enforcing minimum size
@@ -642,46 +406,205 @@ void drawUI(){
             refresh();
 
             // still need to check for quit and wait for resize
-            if (handleInput(procPanel) == -1) {
+            if (!waitForWakeup(signals, sampler.get(), -1, resized, error) || handleKeys(procPanel, cgroupPanel, netPanel, replayer, show_profile, view) == -1) {
                 break;
             }
-            usleep(100000);
+            dirty = true;
             continue; // skipping drawing panels
         }
 
+        // picking up a newer snapshot if the sampler published one (or the next frame is due)
+        if (replayer && replayer->update()){
+            dirty = true;
+        }
+        std::shared_ptr<const SystemSnapshot> latest = replayer ? replayer->latest() : sampler->latest();
+        if (latest->generation != drawn_generation){
+            snapshot = std::move(latest);
+            dirty = true;
+        }
+
+        // republished snapshots only add command lines, they are not new samples
+        if (snapshot->sample != pushed_sample){
+            history.push(*snapshot);
+            pushed_sample = snapshot->sample;
+        }
+
+        // the overlay only fits over a proc panel taller than itself
+        bool profile_fits = terminal_height - proc_panel_top - 1 > ProfilePanel::height() + 1;
+        bool profile_visible = show_profile && profile_fits;
+        if (profile_visible){
+            uint64_t now = monotonicNs();
+            if (now - self_usage_ns >= SELF_USAGE_INTERVAL_NS){
+                self_usage.update();
+                self_usage_ns = now;
+                dirty = true;
+            }
+        }
+
+        if (dirty){
+            // main panel
+            // (the byte count is the previous frame's, this one is still being drawn)
+            status = replayer ? replayer->status() + " | " : std::string();
+            status += "tty " + std::to_string(frame_bytes) + " B/frame";
+            {
+                StageTimer timer(Stage::DrawMain);
+                mainPanel.drawMain(status, quit_text);
+            }
+
+            // cpu stats panel
+            {
+                StageTimer timer(Stage::DrawCpu);
+                cpuPanel.drawCPUStats(*snapshot, history);
+            }
+
+            // system info panel
+            {
+                StageTimer timer(Stage::DrawSysInfo);
+                sysInfoPanel.drawSysInfo(*snapshot);
+            }
+
+            // memory stats panel
+            {
+                StageTimer timer(Stage::DrawMem);
+                memPanel.drawMemStats(*snapshot, history);
+            }
+
+            // pressure stall panel
+            if (pressurePanel){
+                StageTimer timer(Stage::DrawPressure);
+                pressurePanel->drawPressure(*snapshot);
+            }
 
-        // main panel
-        mainPanel.drawPanel();
-        mvwprintw(stdscr, terminal_height - 1, (terminal_width - quit_text.length() - 3), " %s ", quit_text.c_str());
+            // process list panel (or the cgroups or interfaces in its place), everything it covered
+            // copied again once the overlay closes or another view was on screen
+            {
+                StageTimer timer(Stage::DrawProc);
+                bool uncovered = (profile_shown && !profile_visible) || view != view_shown;
+                if (view == ListView::Cgroups){
+                    if (uncovered){
+                        cgroupPanel.touch();
+                    }
+                    cgroupPanel.drawCgroups(snapshot, procPanel.sortKey());
+                } else if (view == ListView::Net){
+                    if (uncovered){
+                        netPanel.touch();
+                    }
+                    netPanel.drawNet(snapshot);
+                } else {
+                    if (uncovered){
+                        procPanel.touch();
+                    }
+                    procPanel.drawProcStats(snapshot, history);
+                }
+                view_shown = view;
+            }
 
-        // cpu stats panel
-        cpuPanel.getCPUStats();
-        cpuPanel.drawCPUStats();
+            // self stats overlay, last so it stays on top
+            if (profile_visible){
+                profilePanel.drawProfile(self_usage, frame_bytes);
+            }
+            profile_shown = profile_visible;
 
-        // system info panel
-        sysInfoPanel.drawSysInfo();
+            {
+                StageTimer timer(Stage::Doupdate);
+                doupdate(); // updating terminal once, only changed cells are sent
+            }
 
-        // memory stats panel
-        memPanel.drawMemStats();
+            unsigned long long written = ttyBytesWritten();
+            frame_bytes = written - tty_written;
+            tty_written = written;
+
+            drawn_generation = snapshot->generation;
+            dirty = false;
+
+            // asking the sampler for the command lines of rows on and around the page
+            procPanel.cmdlineWindow(next_cmdline_window);
+            if (next_cmdline_window != cmdline_window){
+                cmdline_window.swap(next_cmdline_window);
+                if (replayer){
+                    replayer->requestCmdlines(cmdline_window);
+                } else {
+                    sampler->requestCmdlines(cmdline_window);
+                }
+            }
 
-        // process list panel
-        procPanel.drawProcStats();
+            // grouping only costs the sampler anything while the view is on
+            bool show_cgroups = view == ListView::Cgroups;
+            if (sampler && show_cgroups != cgroups_requested){
+                sampler->requestCgroups(show_cgroups);
+                cgroups_requested = show_cgroups;
+            }
 
-        doupdate(); // updating terminal once
+            // and for the disk i/o and PSS of the rows on the page
+            procPanel.shownWindow(next_shown_window);
+            if (next_shown_window != shown_window){
+                shown_window.swap(next_shown_window);
+                if (replayer){
+                    replayer->requestShown(shown_window);
+                } else {
+                    sampler->requestShown(shown_window);
+                }
+            }
+        }
 
-        // quit vtop
-        if (handleInput(procPanel) == -1){
+        // sleeping until something happens: a key, a resize, a new snapshot,
+        // or the next replay frame or overlay refresh coming due
+        int timeout_ms = replayer ? replayer->msUntilDue() : -1;
+        if (profile_visible){
+            uint64_t due = self_usage_ns + SELF_USAGE_INTERVAL_NS;
+            uint64_t now = monotonicNs();
+            int overlay_ms = now >= due ? 0 : static_cast<int>((due - now + 999999) / 1000000);
+            timeout_ms = timeout_ms < 0 ? overlay_ms : std::min(timeout_ms, overlay_ms);
+        }
+        if (!waitForWakeup(signals, sampler.get(), timeout_ms, resized, error)){
             break;
         }
+
+        // every key typed meanwhile, quitting vtop on 'q'
+        int input = handleKeys(procPanel, cgroupPanel, netPanel, replayer, show_profile, view);
+        if (input == -1){
+            break;
+        }
+        if (input == 1){
+            dirty = true;
+        }
     }
+
+    if (sampler){
+        sampler->stop();
+    }
+    return error.empty();
 }
 
-void draw(){
+int draw(const Options &options){
+    // resizes come through a signalfd, SIGWINCH is blocked before any thread
+    // (the replay reader's or the sampler's) starts and could have it delivered instead
+    SignalWatch signals({SIGWINCH});
+
+    // opening a capture before taking over the terminal, so errors can be printed
+    std::unique_ptr<Replayer> replayer;
+    if (!options.replay_path.empty()){
+        replayer.reset(new Replayer());
+        std::string error;
+        if (!replayer->open(options.replay_path, error)){
+            std::cerr << options.replay_path << ": " << error << "\n";
+            return 1;
+        }
+    }
+
     initscr(); // initializing screen
     keypad(stdscr, TRUE); // keypad inputs
     curs_set(0); // hiding the cursor
-    nodelay(stdscr, TRUE); // non-blocking input
+    noecho(); // keys are commands, not text
+    nodelay(stdscr, TRUE); // keys are only read once poll() has seen some arrive
     initializeColors(); // initializing colors
-    drawUI();
+    refresh(); // flushing the blank stdscr now, getch() would repaint it over the panels later
+    std::string error;
+    bool ok = drawUI(options, replayer.get(), signals, error);
     endwin(); // closing window
+    if (!ok){
+        std::cerr << "vtop: " << error << "\n";
+        return 1;
+    }
+    return 0;
 }